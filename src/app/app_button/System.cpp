@@ -24,7 +24,7 @@ System& System::instance()
 }
 
 System::System()
-    : gpio_(interruptMgr_, func_),
+    : gpio_(interruptMgr_, func_, &deferredQueue_),
       uart_(interruptMgr_, func_, SysClockFreq),
       timerDevice_(interruptMgr_),
       buttonDriver_(gpio_, el_),
@@ -36,6 +36,7 @@ System::System()
       stream_(buf_),
       log_("\r\n", stream_)
 {
+    device::DeferredWaitCond<DeferredQueue>::setQueue(deferredQueue_);
 }
 
 extern "C"
@@ -34,6 +34,7 @@
 #include "device/InterruptMgr.h"
 #include "device/Timer.h"
 #include "device/EventLoopDevices.h"
+#include "device/DeferredWorkQueue.h"
 #include "device/Uart1.h"
 
 #include "component/OnBoardLed.h"
@@ -42,15 +43,21 @@
 class System
 {
 public:
+    static const std::size_t DeferredQueueSize = 8;
+    typedef device::DeferredWorkQueue<DeferredQueueSize> DeferredQueue;
+
     static const std::size_t EventLoopSpaceSize = 1024;
     typedef embxx::util::EventLoop<
         EventLoopSpaceSize,
         device::InterruptLock,
-        device::WaitCond> EventLoop;
+        device::DeferredWaitCond<DeferredQueue> > EventLoop;
 
     // Devices
     typedef device::InterruptMgr<> InterruptMgr;
-    typedef device::Gpio<InterruptMgr> Gpio;
+    typedef device::Gpio<
+        InterruptMgr,
+        embxx::util::StaticFunction<void (device::Function::PinIdxType, bool)>,
+        DeferredQueue> Gpio;
     typedef device::Uart1<InterruptMgr> Uart;
     typedef device::Timer<InterruptMgr> TimerDevice;
 
@@ -104,6 +111,7 @@ private:
     System();
 
     EventLoop el_;
+    DeferredQueue deferredQueue_;
 
     // Devices
     InterruptMgr interruptMgr_;
@@ -26,6 +26,7 @@ System& System::instance()
 System::System()
     : gpio_(interruptMgr_, func_),
       uart_(interruptMgr_, func_, SysClockFreq),
+      timerDevice_(interruptMgr_),
       i2c_(interruptMgr_, func_),
       i2cOpQueue_(i2c_),
       i2cCharAdapter1_(i2cOpQueue_, EepromAddress1),
@@ -33,9 +34,13 @@ System::System()
       uartDriver_(uart_, el_),
       i2cDriver1_(i2cCharAdapter1_, el_),
       i2cDriver2_(i2cCharAdapter2_, el_),
+      timerMgr_(timerDevice_, el_),
       led_(gpio_),
       eeprom1_(i2cDriver1_),
       eeprom2_(i2cDriver2_),
+      eepromCache_(eeprom1_, timerMgr_),
+      kvStore_(eeprom1_, KvStoreAddress),
+      eepromStripe_(EepromStripe::Devices{{&eeprom1_, &eeprom2_}}),
       buf_(uartDriver_),
       stream_(buf_),
       log_("\r\n", stream_)
@@ -43,6 +48,11 @@ System::System()
     uart_.configBaud(115200);
     uart_.setWriteEnabled(true);
     i2c_.setDivider(SysClockFreq/I2cFreq);
+
+    // Used to measure duration of eeprom writes. The counter rate belongs
+    // to the application, the idle residency (see device::Idle) is
+    // accounted in the same ticks.
+    device::FreeRunningCounter::enable((SysClockFreq/CounterFreq) - 1);
 }
 
 extern "C"
@@ -23,6 +23,7 @@
 #include "embxx/util/log/StreamableValueSuffixer.h"
 #include "embxx/util/log/StreamFlushSuffixer.h"
 #include "embxx/driver/Character.h"
+#include "embxx/driver/TimerMgr.h"
 #include "embxx/io/OutStreamBuf.h"
 #include "embxx/io/OutStream.h"
 #include "embxx/device/DeviceOpQueue.h"
@@ -32,12 +33,16 @@
 #include "device/Gpio.h"
 #include "device/InterruptMgr.h"
 #include "device/Timer.h"
+#include "device/FreeRunningCounter.h"
 #include "device/EventLoopDevices.h"
 #include "device/Uart1.h"
 #include "device/I2C0.h"
 
 #include "component/OnBoardLed.h"
 #include "component/Eeprom.h"
+#include "component/EepromCache.h"
+#include "component/EepromKvStore.h"
+#include "component/EepromStripe.h"
 
 class System
 {
@@ -54,6 +59,8 @@ public:
 
     typedef device::Uart1<InterruptMgr> Uart;
 
+    typedef device::Timer<InterruptMgr> TimerDevice;
+
     typedef device::I2C0<
         InterruptMgr,
         embxx::util::StaticFunction<void(), sizeof(void*) * 4>,
@@ -75,12 +82,50 @@ public:
 
     typedef embxx::driver::Character<CharI2cAdapter, EventLoop> I2cDriver;
 
+    typedef embxx::driver::TimerMgr<
+        TimerDevice,
+        EventLoop,
+        1
+    > TimerMgr;
+
     typedef component::OnBoardLed<Gpio> Led;
     typedef component::Eeprom<
         I2cDriver,
         embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&, std::size_t), sizeof(void*) * 6>
     > Eeprom;
 
+    // Eeprom write page
+    static const std::size_t EepromPageSize = 128;
+
+    static const std::size_t EepromCachePageCount = 4;
+    typedef component::EepromCache<
+        Eeprom,
+        TimerMgr,
+        EepromPageSize,
+        EepromCachePageCount
+    > EepromCache;
+
+    // Area of endless read/write, the components are exercised beyond it
+    static const Eeprom::EepromAddressType EepromRwAreaSize = 4 * 1024; // 4KB
+
+    static const Eeprom::EepromAddressType KvStoreAddress = EepromRwAreaSize;
+    static const std::size_t KvStorePageCount = 4;
+    static const std::size_t KvStoreMaxKeys = 8;
+    static const std::size_t KvStoreMaxValueSize = 32;
+    typedef component::EepromKvStore<
+        Eeprom,
+        EepromPageSize,
+        KvStorePageCount,
+        KvStoreMaxKeys,
+        KvStoreMaxValueSize
+    > KvStore;
+
+    // Both eeproms share the bus via the operation queue
+    typedef component::EepromStripe<Eeprom, 2> EepromStripe;
+
+    // Free running counter ticks every microsecond
+    static const unsigned CounterFreq = 1000000; // 1MHz
+
     static const std::size_t OutStreamBufSize = 1024;
     typedef embxx::io::OutStreamBuf<UartDriver, OutStreamBufSize> OutStreamBuf;
     typedef embxx::io::OutStream<OutStreamBuf> OutStream;
@@ -104,6 +149,9 @@ public:
     inline Led& led();
     inline Eeprom& eeprom1();
     inline Eeprom& eeprom2();
+    inline EepromCache& eepromCache();
+    inline KvStore& kvStore();
+    inline EepromStripe& eepromStripe();
     inline Log& log();
 
 private:
@@ -116,6 +164,7 @@ private:
     device::Function func_;
     Gpio gpio_;
     Uart uart_;
+    TimerDevice timerDevice_;
     I2C i2c_;
     I2cOpQueue i2cOpQueue_;
     CharI2cAdapter i2cCharAdapter1_;
@@ -125,11 +174,15 @@ private:
     UartDriver uartDriver_;
     I2cDriver i2cDriver1_;
     I2cDriver i2cDriver2_;
+    TimerMgr timerMgr_;
 
     // Components
     Led led_;
     Eeprom eeprom1_;
     Eeprom eeprom2_;
+    EepromCache eepromCache_;
+    KvStore kvStore_;
+    EepromStripe eepromStripe_;
     OutStreamBuf buf_;
     OutStream stream_;
     Log log_;
@@ -172,6 +225,21 @@ inline System::Eeprom& System::eeprom2()
     return eeprom2_;
 }
 
+inline System::EepromCache& System::eepromCache()
+{
+    return eepromCache_;
+}
+
+inline System::KvStore& System::kvStore()
+{
+    return kvStore_;
+}
+
+inline System::EepromStripe& System::eepromStripe()
+{
+    return eepromStripe_;
+}
+
 inline
 System::Log& System::log()
 {
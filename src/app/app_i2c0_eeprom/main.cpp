@@ -20,10 +20,11 @@
 #include <functional>
 #include <cstdint>
 #include <array>
+#include <algorithm>
+#include <type_traits>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StreamLogger.h"
-#include "embxx/io/access.h"
 
 namespace
 {
@@ -97,11 +98,9 @@ void writeFunc(
         return;
     }
 
-    auto bufIter = &buf[0];
-    embxx::io::writeBig(address, bufIter);
-    std::size_t writeCount = std::min(bufSize, std::size_t(maxAddress - address) + sizeof(address));
+    std::size_t writeCount = std::min(bufSize, std::size_t(maxAddress - address));
 
-    eeprom.asyncWrite(buf, writeCount,
+    eeprom.asyncWrite(address, buf, writeCount,
         [&eeprom, address, buf, bufSize, maxAddress, writeCount](const embxx::error::ErrorStatus& err, std::size_t bytesTransferred)
         {
             auto& log = System::instance().log();
@@ -116,18 +115,17 @@ void writeFunc(
 
             GASSERT(bytesTransferred == writeCount);
             static_cast<void>(bytesTransferred);
-            auto writtenDataCount = writeCount - sizeof(address);
             SLOG(log, embxx::util::log::Info,
                 "W (0x" << embxx::io::hex << embxx::io::setw(0) <<
                 eeprom.getDeviceId() << ") : [0x" <<
                 embxx::io::setfill('0') << embxx::io::setw(sizeof(address) * 2) <<
-                address << " - 0x" << address + (writtenDataCount - 1) <<
+                address << " - 0x" << address + (writeCount - 1) <<
                 "] : {0x" << embxx::io::setw(sizeof(System::I2C::CharType) * 2) <<
-                static_cast<unsigned>(buf[sizeof(address)]) << " .. 0x" <<
+                static_cast<unsigned>(buf[0]) << " .. 0x" <<
                 static_cast<unsigned>(buf[writeCount - 1]) << "} " <<
-                embxx::io::setw(0) << embxx::io::dec << writtenDataCount << " bytes");
+                embxx::io::setw(0) << embxx::io::dec << writeCount << " bytes");
 
-            writeFunc(eeprom, address + writtenDataCount, buf, bufSize, maxAddress);
+            writeFunc(eeprom, address + writeCount, buf, bufSize, maxAddress);
         });
 }
 
@@ -143,63 +141,435 @@ void readFunc(
         return;
     }
 
-    auto bufIter = &buf[0];
-    embxx::io::writeBig(address, bufIter);
+    std::size_t readCount = std::min(bufSize, std::size_t(maxAddress - address));
 
-    eeprom.asyncWrite(buf, sizeof(address),
-        [&eeprom, address, buf, bufSize, maxAddress](const embxx::error::ErrorStatus& err, std::size_t bytesWritten)
+    eeprom.asyncRead(address, buf, readCount,
+        [&eeprom, address, buf, bufSize, maxAddress, readCount](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
         {
             auto& log = System::instance().log();
+
             if (err) {
                 SLOG(log, embxx::util::log::Error,
                     "R (0x" << embxx::io::hex << embxx::io::setw(0) <<
-                    eeprom.getDeviceId() << ") : Failed to set address with error " <<
+                    eeprom.getDeviceId() << ") : Failed to read with error " <<
                     err);
                 return;
             }
 
-            static_cast<void>(bytesWritten);
-            GASSERT(bytesWritten == sizeof(address));
-            std::size_t readCount = std::min(bufSize - sizeof(address), std::size_t(maxAddress - address));
+            static_cast<void>(bytesRead);
+            GASSERT(bytesRead == readCount);
 
-            eeprom.asyncRead(&buf[sizeof(address)], readCount,
-                [&eeprom, address, buf, bufSize, maxAddress, readCount](const embxx::error::ErrorStatus& err2, std::size_t bytesRead)
-                {
-                    auto& log2 = System::instance().log();
+            auto readBuf = buf;
+            SLOG(log, embxx::util::log::Info,
+                "R (0x" << embxx::io::hex << embxx::io::setw(0) <<
+                eeprom.getDeviceId() << ") : [0x" <<
+                embxx::io::setfill('0') << embxx::io::setw(sizeof(address) * 2) <<
+                address << " - 0x" << address + (readCount - 1) <<
+                "] : {0x" << embxx::io::setw(sizeof(System::I2C::CharType) * 2) <<
+                static_cast<unsigned>(readBuf[0]) << " .. 0x" <<
+                static_cast<unsigned>(readBuf[readCount - 1]) << "} " <<
+                embxx::io::setw(0) << embxx::io::dec << readCount << " bytes");
+
+            if (!verifySeqCorrect(&readBuf[0], readCount)) {
+                SLOG(log, embxx::util::log::Error,
+                    "Read mismatch for 0x" << eeprom.getDeviceId() << "!!!");
+                return;
+            }
+
+            readFunc(eeprom, address + readCount, buf, bufSize, maxAddress);
+        });
+}
+
+static const std::size_t BufSize = System::EepromPageSize;
+typedef std::array<System::Eeprom::CharType, BufSize> DataBuf;
+DataBuf data1;
+DataBuf data2;
+
+void startReadWriteLoop()
+{
+    auto& system = System::instance();
+    auto& log = system.log();
+    SLOG(log, embxx::util::log::Info, "Starting Write...");
+
+    writeFunc(system.eeprom1(), 0, &data1[0], BufSize, System::EepromRwAreaSize);
+    writeFunc(system.eeprom2(), 0, &data2[0], BufSize, System::EepromRwAreaSize);
+}
+
+void runNextTest();
 
-                    if (err2) {
-                        SLOG(log2, embxx::util::log::Error,
-                            "R (0x" << embxx::io::hex << embxx::io::setw(0) <<
-                            eeprom.getDeviceId() << ") : Failed to read with error " <<
-                            err2);
+void reportTestFailure(
+    const char* test,
+    const char* step,
+    const embxx::error::ErrorStatus& err)
+{
+    SLOG(System::instance().log(), embxx::util::log::Error,
+        test << ": " << step << " failed with error " << err);
+}
+
+// Small writes into eeprom1 via cache, coalesced into page writes by flush
+static const System::Eeprom::EepromAddressType CacheTestAddress =
+    System::KvStoreAddress + (System::KvStorePageCount * System::EepromPageSize);
+static const std::size_t CacheTestWriteSize = 8;
+static const std::size_t CacheTestSize =
+    System::EepromPageSize * System::EepromCachePageCount;
+typedef std::array<System::Eeprom::CharType, CacheTestSize> CacheTestBuf;
+CacheTestBuf cacheTestData;
+CacheTestBuf cacheTestReadBuf;
+
+void cacheTestVerify()
+{
+    // Bypass the cache, the data is expected to be on the device
+    System::instance().eeprom1().asyncRead(
+        CacheTestAddress,
+        &cacheTestReadBuf[0],
+        cacheTestReadBuf.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            if (err) {
+                reportTestFailure("Cache", "Read", err);
+                return;
+            }
+
+            auto& log = System::instance().log();
+            if ((bytesRead != cacheTestReadBuf.size()) ||
+                (cacheTestReadBuf != cacheTestData)) {
+                SLOG(log, embxx::util::log::Error, "Cache: Read mismatch!!!");
+                return;
+            }
+
+            SLOG(log, embxx::util::log::Info,
+                "Cache: " << embxx::io::dec <<
+                CacheTestSize / CacheTestWriteSize << " writes flushed as " <<
+                System::EepromCachePageCount << " page writes, verified");
+            runNextTest();
+        });
+}
+
+void cacheTestFlush()
+{
+    auto& cache = System::instance().eepromCache();
+    auto flushed = cache.asyncFlush(
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            if (err) {
+                reportTestFailure("Cache", "Flush", err);
+                return;
+            }
+
+            cacheTestVerify();
+        });
+
+    if (flushed) {
+        cacheTestVerify();
+    }
+}
+
+void cacheTestWrite(std::size_t offset)
+{
+    auto& cache = System::instance().eepromCache();
+    while (offset < CacheTestSize) {
+        auto written = cache.asyncWrite(
+            static_cast<System::Eeprom::EepromAddressType>(CacheTestAddress + offset),
+            &cacheTestData[offset],
+            CacheTestWriteSize,
+            [offset](const embxx::error::ErrorStatus& err, std::size_t)
+            {
+                if (err) {
+                    reportTestFailure("Cache", "Write", err);
+                    return;
+                }
+
+                cacheTestWrite(offset + CacheTestWriteSize);
+            });
+
+        if (!written) {
+            return; // Page is being loaded
+        }
+        offset += CacheTestWriteSize;
+    }
+
+    cacheTestFlush();
+}
+
+void cacheTest()
+{
+    for (auto i = 0U; i < cacheTestData.size(); ++i) {
+        cacheTestData[i] = static_cast<System::Eeprom::CharType>(i ^ 0xa5);
+    }
+
+    cacheTestWrite(0);
+}
+
+// Key/value store on eeprom1. The first key holds the boot counter,
+// the second one is written and removed, the result is verified after
+// remount.
+static const System::KvStore::KeyType KvTestCounterKey = 1;
+static const System::KvStore::KeyType KvTestRemovedKey = 2;
+static const std::size_t KvTestValueSize = 16;
+typedef std::array<System::Eeprom::CharType, KvTestValueSize> KvTestBuf;
+KvTestBuf kvTestValue;
+KvTestBuf kvTestReadBuf;
+
+void kvTestRemount();
+
+bool kvTestAccepted(bool result, const char* step)
+{
+    if (!result) {
+        SLOG(System::instance().log(), embxx::util::log::Error,
+            "KvStore: " << step << " rejected");
+    }
+    return result;
+}
+
+void kvTestRemove()
+{
+    auto& store = System::instance().kvStore();
+    auto result = store.asyncRemove(
+        KvTestRemovedKey,
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            if (err) {
+                reportTestFailure("KvStore", "Remove", err);
+                return;
+            }
+
+            // No background garbage collection is in progress in the
+            // completion callback, the store may be mounted again.
+            kvTestRemount();
+        });
+    kvTestAccepted(result, "Remove");
+}
+
+void kvTestWrite(System::Eeprom::CharType counter)
+{
+    for (auto i = 0U; i < kvTestValue.size(); ++i) {
+        kvTestValue[i] = static_cast<System::Eeprom::CharType>(counter + i);
+    }
+
+    auto& store = System::instance().kvStore();
+    auto result = store.asyncWrite(
+        KvTestCounterKey,
+        &kvTestValue[0],
+        kvTestValue.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            if (err) {
+                reportTestFailure("KvStore", "Write", err);
+                return;
+            }
+
+            auto& store = System::instance().kvStore();
+            auto result = store.asyncWrite(
+                KvTestRemovedKey,
+                &kvTestValue[0],
+                kvTestValue.size() / 2,
+                [](const embxx::error::ErrorStatus& err, std::size_t)
+                {
+                    if (err) {
+                        reportTestFailure("KvStore", "Write", err);
                         return;
                     }
 
-                    static_cast<void>(bytesRead);
-                    GASSERT(bytesRead == readCount);
-
-                    auto readBuf = &buf[sizeof(address)];
-                    SLOG(log2, embxx::util::log::Info,
-                        "R (0x" << embxx::io::hex << embxx::io::setw(0) <<
-                        eeprom.getDeviceId() << ") : [0x" <<
-                        embxx::io::setfill('0') << embxx::io::setw(sizeof(address) * 2) <<
-                        address << " - 0x" << address + (readCount - 1) <<
-                        "] : {0x" << embxx::io::setw(sizeof(System::I2C::CharType) * 2) <<
-                        static_cast<unsigned>(readBuf[0]) << " .. 0x" <<
-                        static_cast<unsigned>(readBuf[readCount - 1]) << "} " <<
-                        embxx::io::setw(0) << embxx::io::dec << readCount << " bytes");
-
-                    if (!verifySeqCorrect(&readBuf[0], readCount)) {
-                        SLOG(log2, embxx::util::log::Error,
-                            "Read mismatch for 0x" << eeprom.getDeviceId() << "!!!");
+                    kvTestRemove();
+                });
+            kvTestAccepted(result, "Write");
+        });
+    kvTestAccepted(result, "Write");
+}
+
+void kvTestVerify()
+{
+    auto& store = System::instance().kvStore();
+    auto& log = System::instance().log();
+    if ((store.getValueSize(KvTestRemovedKey) != 0) ||
+        (store.getValueSize(KvTestCounterKey) != kvTestValue.size())) {
+        SLOG(log, embxx::util::log::Error, "KvStore: Unexpected keys after remount!!!");
+        return;
+    }
+
+    auto result = store.asyncRead(
+        KvTestCounterKey,
+        &kvTestReadBuf[0],
+        kvTestReadBuf.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t size)
+        {
+            if (err) {
+                reportTestFailure("KvStore", "Read", err);
+                return;
+            }
+
+            auto& log = System::instance().log();
+            if ((size != kvTestValue.size()) || (kvTestReadBuf != kvTestValue)) {
+                SLOG(log, embxx::util::log::Error, "KvStore: Read mismatch!!!");
+                return;
+            }
+
+            SLOG(log, embxx::util::log::Info,
+                "KvStore: boot counter " << embxx::io::dec <<
+                static_cast<unsigned>(kvTestValue[0]) <<
+                ", verified after remount");
+            runNextTest();
+        });
+    kvTestAccepted(result, "Read");
+}
+
+void kvTestRemount()
+{
+    System::instance().kvStore().asyncMount(
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            if (err) {
+                reportTestFailure("KvStore", "Remount", err);
+                return;
+            }
+
+            kvTestVerify();
+        });
+}
+
+void kvStoreTest()
+{
+    System::instance().kvStore().asyncMount(
+        [](const embxx::error::ErrorStatus& err, std::size_t keysCount)
+        {
+            if (err) {
+                reportTestFailure("KvStore", "Mount", err);
+                return;
+            }
+
+            auto& store = System::instance().kvStore();
+            SLOG(System::instance().log(), embxx::util::log::Info,
+                "KvStore: mounted with " << embxx::io::dec << keysCount << " keys");
+
+            if (store.getValueSize(KvTestCounterKey) != kvTestReadBuf.size()) {
+                kvTestWrite(0); // First boot
+                return;
+            }
+
+            auto result = store.asyncRead(
+                KvTestCounterKey,
+                &kvTestReadBuf[0],
+                kvTestReadBuf.size(),
+                [](const embxx::error::ErrorStatus& err, std::size_t)
+                {
+                    if (err) {
+                        reportTestFailure("KvStore", "Read", err);
                         return;
                     }
 
-                    readFunc(eeprom, address + readCount, buf, bufSize, maxAddress);
+                    kvTestWrite(
+                        static_cast<System::Eeprom::CharType>(kvTestReadBuf[0] + 1));
                 });
+            kvTestAccepted(result, "Read");
         });
 }
 
+// Same amount of data is written into eeprom1 only and striped over both
+// eeproms, the write cycle of one eeprom overlaps with the transfer to the
+// other one.
+static const System::Eeprom::EepromAddressType StripeTestDeviceAddress =
+    CacheTestAddress + CacheTestSize;
+static const System::EepromStripe::AddressType StripeTestAddress =
+    StripeTestDeviceAddress * System::EepromStripe::Count;
+static const std::size_t StripeTestSize = System::EepromPageSize * 8;
+typedef std::array<System::Eeprom::CharType, StripeTestSize> StripeTestBuf;
+StripeTestBuf stripeTestData;
+StripeTestBuf stripeTestReadBuf;
+device::FreeRunningCounter::TicksType stripeTestStartTicks = 0;
+device::FreeRunningCounter::TicksType stripeTestSingleTicks = 0;
+device::FreeRunningCounter::TicksType stripeTestStripedTicks = 0;
+
+void stripeTestVerify()
+{
+    System::instance().eepromStripe().asyncRead(
+        StripeTestAddress,
+        &stripeTestReadBuf[0],
+        stripeTestReadBuf.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            if (err) {
+                reportTestFailure("Stripe", "Read", err);
+                return;
+            }
+
+            auto& log = System::instance().log();
+            if ((bytesRead != stripeTestReadBuf.size()) ||
+                (stripeTestReadBuf != stripeTestData)) {
+                SLOG(log, embxx::util::log::Error, "Stripe: Read mismatch!!!");
+                return;
+            }
+
+            SLOG(log, embxx::util::log::Info,
+                "Stripe: " << embxx::io::dec << StripeTestSize <<
+                " bytes written in " << stripeTestSingleTicks <<
+                " us by single eeprom, in " << stripeTestStripedTicks <<
+                " us by " << System::EepromStripe::Count <<
+                " eeproms, verified");
+            runNextTest();
+        });
+}
+
+void stripeTestStripedWrite()
+{
+    stripeTestStartTicks = device::FreeRunningCounter::ticks();
+    System::instance().eepromStripe().asyncWrite(
+        StripeTestAddress,
+        &stripeTestData[0],
+        stripeTestData.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            stripeTestStripedTicks =
+                device::FreeRunningCounter::ticks() - stripeTestStartTicks;
+            if (err) {
+                reportTestFailure("Stripe", "Striped write", err);
+                return;
+            }
+
+            stripeTestVerify();
+        });
+}
+
+void stripeTest()
+{
+    for (auto i = 0U; i < stripeTestData.size(); ++i) {
+        stripeTestData[i] = static_cast<System::Eeprom::CharType>(i * 3);
+    }
+
+    stripeTestStartTicks = device::FreeRunningCounter::ticks();
+    System::instance().eeprom1().asyncWrite(
+        StripeTestDeviceAddress,
+        &stripeTestData[0],
+        stripeTestData.size(),
+        [](const embxx::error::ErrorStatus& err, std::size_t)
+        {
+            stripeTestSingleTicks =
+                device::FreeRunningCounter::ticks() - stripeTestStartTicks;
+            if (err) {
+                reportTestFailure("Stripe", "Single write", err);
+                return;
+            }
+
+            stripeTestStripedWrite();
+        });
+}
+
+typedef void (*TestFunc)();
+const TestFunc Tests[] = {
+    &cacheTest,
+    &kvStoreTest,
+    &stripeTest,
+    &startReadWriteLoop // Must be last
+};
+
+void runNextTest()
+{
+    static std::size_t nextTest = 0;
+    GASSERT(nextTest < std::extent<decltype(Tests)>::value);
+    auto func = Tests[nextTest];
+    ++nextTest;
+    func();
+}
+
 }  // namespace
 
 int main() {
@@ -209,35 +579,29 @@ int main() {
     // Led on on assertion failure.
     embxx::util::EnableAssert<LedOnAssert> assertion(std::ref(led));
 
-    auto& log = system.log();
-    SLOG(log, embxx::util::log::Info, "Starting Write...");
-
-    static const std::size_t ChunkSize = 128; // Maximum supported by eeprom
-    static const std::size_t BufSize = ChunkSize + sizeof(System::Eeprom::EepromAddressType);
-    typedef std::array<System::Eeprom::CharType, BufSize> DataBuf;
-
-    DataBuf data1;
-    for (auto i = 0U; i < ChunkSize; ++i) {
-        auto idx = i + sizeof(System::Eeprom::EepromAddressType);
-        data1[idx] = static_cast<System::Eeprom::CharType>(i);
+    for (auto i = 0U; i < BufSize; ++i) {
+        data1[i] = static_cast<System::Eeprom::CharType>(i);
     }
 
-    DataBuf data2;
-    for (auto i = 0U; i < ChunkSize; ++i) {
-        auto idx = i + sizeof(System::Eeprom::EepromAddressType);
-        data2[idx] = static_cast<System::Eeprom::CharType>(ChunkSize - (i + 1));
+    for (auto i = 0U; i < BufSize; ++i) {
+        data2[i] = static_cast<System::Eeprom::CharType>(BufSize - (i + 1));
     }
 
     static const System::Eeprom::AttemtsCountType EepromAttemptCount = 20;
+    // Every poll takes ~0.2ms at 100KHz, while write cycle is up to 5ms
+    static const System::Eeprom::AttemtsCountType EepromWriteCyclePollsCount = 100;
     auto& eeprom1 = system.eeprom1();
     eeprom1.setAttemptsLimit(EepromAttemptCount);
+    eeprom1.setWriteCyclePollsLimit(EepromWriteCyclePollsCount);
+    eeprom1.setPageSize(System::EepromPageSize);
     auto& eeprom2 = system.eeprom2();
     eeprom2.setAttemptsLimit(EepromAttemptCount);
+    eeprom2.setWriteCyclePollsLimit(EepromWriteCyclePollsCount);
+    eeprom2.setPageSize(System::EepromPageSize);
 
-    static const System::Eeprom::EepromAddressType MaxAddress = 4 * 1024; // 4KB
-
-    writeFunc(eeprom1, 0, &data1[0], BufSize, MaxAddress);
-    writeFunc(eeprom2, 0, &data2[0], BufSize, MaxAddress);
+    // The components are exercised one by one, followed by endless
+    // parallel write/read of both eeproms
+    runNextTest();
 
     device::interrupt::enable();
     auto& el = system.eventLoop();
@@ -0,0 +1,65 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "System.h"
+
+System& System::instance()
+{
+    static System system;
+    return system;
+}
+
+System::System()
+    : gpio_(interruptMgr_, func_),
+      auxInterruptMgr_(interruptMgr_),
+      uart_(interruptMgr_, func_, SysClockFreq, &auxInterruptMgr_),
+      timerDevice_(interruptMgr_),
+      spi_(interruptMgr_, func_),
+      spiOpQueue_(spi_),
+      spiCharAdapter_(spiOpQueue_, SpiDevIdx),
+      auxSpi_(auxInterruptMgr_, func_, AuxSpi::Bus_Spi1),
+      auxSpiOpQueue_(auxSpi_),
+      auxSpiCharAdapter_(auxSpiOpQueue_, AuxSpiDevIdx),
+      uartDriver_(uart_, el_),
+      spiDriver_(spiCharAdapter_, el_),
+      auxSpiDriver_(auxSpiCharAdapter_, el_),
+      timerMgr_(timerDevice_, el_),
+      led_(gpio_),
+      buf_(uartDriver_),
+      stream_(buf_),
+      log_("\r\n", stream_)
+{
+    // Timer pre-empts long SPI FIFO servicing, UART logging stays at
+    // the lowest level together with SPI. UART and SPI1 share the AUX
+    // interrupt.
+    interruptMgr_.setPriority(
+        InterruptMgr::IrqId_Timer,
+        InterruptMgr::NumOfPriorityLevels - 1);
+
+    uart_.configBaud(115200);
+    uart_.setWriteEnabled(true);
+    spi_.setFreq(SysClockFreq, SpiFreq);
+    spi_.setMode(Spi::Mode0);
+    auxSpi_.setFreq(SysClockFreq, SpiFreq);
+    auxSpi_.setMode(AuxSpi::Mode0);
+}
+
+extern "C"
+void interruptHandler()
+{
+    System::instance().interruptMgr().handleInterrupt();
+}
@@ -0,0 +1,218 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "embxx/util/EventLoop.h"
+#include "embxx/util/StreamLogger.h"
+#include "embxx/util/log/LevelStringPrefixer.h"
+#include "embxx/util/log/StreamableValueSuffixer.h"
+#include "embxx/util/log/StreamFlushSuffixer.h"
+#include "embxx/driver/Character.h"
+#include "embxx/driver/TimerMgr.h"
+#include "embxx/io/OutStreamBuf.h"
+#include "embxx/io/OutStream.h"
+#include "embxx/device/DeviceOpQueue.h"
+#include "embxx/device/IdDeviceCharAdapter.h"
+
+#include "device/Function.h"
+#include "device/Gpio.h"
+#include "device/InterruptMgr.h"
+#include "device/Timer.h"
+#include "device/EventLoopDevices.h"
+#include "device/AuxInterruptMgr.h"
+#include "device/Uart1.h"
+#include "device/Spi0.h"
+#include "device/AuxSpi.h"
+
+#include "component/OnBoardLed.h"
+
+class System
+{
+public:
+    // Set to 1 to measure latency without interrupts nesting
+    static const std::size_t InterruptPriorityLevels = 2;
+
+    static const std::size_t EventLoopSpaceSize = 1024;
+    typedef embxx::util::EventLoop<
+        EventLoopSpaceSize,
+        device::BasicInterruptLock<(1 < InterruptPriorityLevels)>,
+        device::WaitCond> EventLoop;
+
+    // Devices
+    typedef device::InterruptMgr<
+        embxx::util::StaticFunction<void ()>,
+        false,
+        InterruptPriorityLevels> InterruptMgr;
+    typedef device::Gpio<InterruptMgr> Gpio;
+    typedef device::AuxInterruptMgr<InterruptMgr> AuxInterruptMgr;
+    typedef device::Uart1<
+        InterruptMgr,
+        embxx::util::StaticFunction<void()>,
+        embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&)>,
+        AuxInterruptMgr> Uart;
+    typedef device::Timer<InterruptMgr> TimerDevice;
+    typedef device::Spi0<
+        InterruptMgr,
+        embxx::util::StaticFunction<void(), sizeof(void*) * 4>,
+        embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&)> > Spi;
+    typedef embxx::device::DeviceOpQueue<Spi, 1> SpiOpQueue;
+    typedef embxx::device::IdDeviceCharAdapter<SpiOpQueue> CharSpiAdapter;
+    typedef device::AuxSpi<
+        AuxInterruptMgr,
+        embxx::util::StaticFunction<void(), sizeof(void*) * 4>,
+        embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&)> > AuxSpi;
+    typedef embxx::device::DeviceOpQueue<AuxSpi, 1> AuxSpiOpQueue;
+    typedef embxx::device::IdDeviceCharAdapter<AuxSpiOpQueue> CharAuxSpiAdapter;
+
+    // Drivers
+    struct CharacterTraits
+    {
+        typedef std::nullptr_t ReadHandler;
+        typedef embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&, std::size_t)> WriteHandler;
+        typedef std::nullptr_t ReadUntilPred;
+        static const std::size_t ReadQueueSize = 0;
+        static const std::size_t WriteQueueSize = 1;
+    };
+    typedef embxx::driver::Character<Uart, EventLoop, CharacterTraits> UartDriver;
+    typedef embxx::driver::Character<CharSpiAdapter, EventLoop, CharacterTraits> SpiDriver;
+    typedef embxx::driver::Character<CharAuxSpiAdapter, EventLoop, CharacterTraits> AuxSpiDriver;
+    typedef embxx::driver::TimerMgr<
+        TimerDevice,
+        EventLoop,
+        1,
+        embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&), sizeof(void*) * 4>
+    > TimerMgr;
+
+    // Components
+    typedef component::OnBoardLed<Gpio> Led;
+    static const std::size_t OutStreamBufSize = 1024;
+    typedef embxx::io::OutStreamBuf<UartDriver, OutStreamBufSize> OutStreamBuf;
+    typedef embxx::io::OutStream<OutStreamBuf> OutStream;
+    typedef embxx::util::log::StreamFlushSuffixer<
+            embxx::util::log::StreamableValueSuffixer<
+                const OutStream::CharType*,
+                embxx::util::log::LevelStringPrefixer<
+                    embxx::util::StreamLogger<
+                        embxx::util::log::Debug,
+                        OutStream
+                    >
+                >
+            >
+        > Log;
+
+    static System& instance();
+    inline EventLoop& eventLoop();
+
+    // Devices
+    inline InterruptMgr& interruptMgr();
+    inline TimerDevice& timerDevice();
+
+    // Drivers
+    inline SpiDriver& spi();
+    inline AuxSpiDriver& auxSpi();
+    inline TimerMgr& timerMgr();
+
+    // Components
+    inline Led& led();
+    inline Log& log();
+
+private:
+    System();
+
+    EventLoop el_;
+
+    // Devices
+    InterruptMgr interruptMgr_;
+    device::Function func_;
+    Gpio gpio_;
+    AuxInterruptMgr auxInterruptMgr_;
+    Uart uart_;
+    TimerDevice timerDevice_;
+    Spi spi_;
+    SpiOpQueue spiOpQueue_;
+    CharSpiAdapter spiCharAdapter_;
+    AuxSpi auxSpi_;
+    AuxSpiOpQueue auxSpiOpQueue_;
+    CharAuxSpiAdapter auxSpiCharAdapter_;
+
+    // Drivers
+    UartDriver uartDriver_;
+    SpiDriver spiDriver_;
+    AuxSpiDriver auxSpiDriver_;
+    TimerMgr timerMgr_;
+
+    // Components
+    Led led_;
+    OutStreamBuf buf_;
+    OutStream stream_;
+    Log log_;
+
+    static const unsigned SysClockFreq = 250000000; // 250MHz
+    static const unsigned SpiFreq = 4000000; // 4MHz
+    static const Spi::DeviceIdType SpiDevIdx = 0;
+    static const AuxSpi::DeviceIdType AuxSpiDevIdx = 0;
+};
+
+extern "C"
+void interruptHandler();
+
+// Implementation
+
+inline
+System::EventLoop& System::eventLoop()
+{
+    return el_;
+}
+
+inline System::InterruptMgr& System::interruptMgr()
+{
+    return interruptMgr_;
+}
+
+inline System::TimerDevice& System::timerDevice()
+{
+    return timerDevice_;
+}
+
+inline System::SpiDriver& System::spi()
+{
+    return spiDriver_;
+}
+
+inline System::AuxSpiDriver& System::auxSpi()
+{
+    return auxSpiDriver_;
+}
+
+inline System::TimerMgr& System::timerMgr()
+{
+    return timerMgr_;
+}
+
+inline
+System::Led& System::led()
+{
+    return led_;
+}
+
+inline
+System::Log& System::log()
+{
+    return log_;
+}
+
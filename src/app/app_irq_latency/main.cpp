@@ -0,0 +1,151 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "System.h"
+
+#include <functional>
+#include <chrono>
+#include <array>
+#include <cstdint>
+
+#include "embxx/util/Assert.h"
+
+namespace
+{
+
+class LedOnAssert : public embxx::util::Assert
+{
+public:
+    typedef System::Led Led;
+    LedOnAssert(Led& led)
+        : led_(led)
+    {
+    }
+
+    virtual void fail(
+        const char* expr,
+        const char* file,
+        unsigned int line,
+        const char* function)
+    {
+        static_cast<void>(expr);
+        static_cast<void>(file);
+        static_cast<void>(line);
+        static_cast<void>(function);
+
+        led_.on();
+        while (true) {;}
+    }
+
+private:
+    Led& led_;
+};
+
+namespace log = embxx::util::log;
+
+static const std::size_t SpiBufSize = 1024;
+typedef std::array<std::uint8_t, SpiBufSize> SpiBuf;
+
+template <typename TSpi>
+void performSpiTraffic(TSpi& spi, const SpiBuf& buf)
+{
+    spi.asyncWrite(
+        &buf[0],
+        buf.size(),
+        [&spi, &buf](const embxx::error::ErrorStatus& es, std::size_t bytesWritten)
+        {
+            GASSERT(!es);
+            GASSERT(bytesWritten == buf.size());
+            static_cast<void>(es);
+            static_cast<void>(bytesWritten);
+            performSpiTraffic(spi, buf);
+        });
+}
+
+struct LatencyInfo
+{
+    unsigned count_;
+    unsigned total_;
+    unsigned max_;
+};
+
+template <typename TTimer>
+void measureLatency(TTimer& timer, LatencyInfo& info)
+{
+    static const auto WaitPeriod = std::chrono::milliseconds(1);
+    static const unsigned ReportPeriod = 1000; // Every second
+
+    timer.asyncWait(
+        WaitPeriod,
+        [&timer, &info](const embxx::error::ErrorStatus& es)
+        {
+            GASSERT(!es);
+            static_cast<void>(es);
+
+            auto& system = System::instance();
+            auto latency = system.timerDevice().getLastIrqLatency();
+            ++info.count_;
+            info.total_ += latency;
+            if (info.max_ < latency) {
+                info.max_ = latency;
+            }
+
+            if (ReportPeriod <= info.count_) {
+                SLOG(system.log(), log::Info,
+                    "Timer IRQ latency (us): avg = " <<
+                    embxx::io::dec << (info.total_ / info.count_) <<
+                    "; max = " << info.max_ <<
+                    "; priority levels = " <<
+                    System::InterruptMgr::NumOfPriorityLevels);
+                info = LatencyInfo();
+            }
+
+            measureLatency(timer, info);
+        });
+}
+
+}  // namespace
+
+int main() {
+    auto& system = System::instance();
+    auto& led = system.led();
+
+    // Led on on assertion failure.
+    embxx::util::EnableAssert<LedOnAssert> assertion(std::ref(led));
+
+    // Continuous traffic on SPI0 and SPI1 in parallel
+    static SpiBuf spiBuf;
+    spiBuf.fill(0xa5);
+    performSpiTraffic(system.spi(), spiBuf);
+    performSpiTraffic(system.auxSpi(), spiBuf);
+
+    // Allocate Timer
+    auto timer = system.timerMgr().allocTimer();
+    GASSERT(timer.isValid());
+
+    // Start measurements
+    LatencyInfo info = LatencyInfo();
+    measureLatency(timer, info);
+
+    // Run event loop
+    device::interrupt::enable();
+    auto& el = system.eventLoop();
+    el.run();
+
+    GASSERT(0); // Mustn't exit
+    return 0;
+}
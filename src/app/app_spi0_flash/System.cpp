@@ -26,7 +26,9 @@ System& System::instance()
 System::System()
     : gpio_(interruptMgr_, func_),
       uart_(interruptMgr_, func_, SysClockFreq),
-      spi_(interruptMgr_, func_),
+      spiTxDma_(interruptMgr_, SpiTxDmaChannel),
+      spiRxDma_(interruptMgr_, SpiRxDmaChannel),
+      spi_(interruptMgr_, func_, Spi::Mode0, &spiTxDma_, &spiRxDma_),
       spiOpQueue_(spi_),
       spiCharAdapter_(spiOpQueue_, SpiDevIdx),
       uartDriver_(uart_, el_),
@@ -34,8 +36,7 @@ System::System()
       led_(gpio_),
       buf_(uartDriver_),
       stream_(buf_),
-      log_("\r\n", stream_),
-      spiInBuf_(spiDriver_)
+      log_("\r\n", stream_)
 {
     uart_.configBaud(115200);
     uart_.setWriteEnabled(true);
@@ -23,7 +23,6 @@
 #include "embxx/util/log/StreamableValueSuffixer.h"
 #include "embxx/util/log/StreamFlushSuffixer.h"
 #include "embxx/driver/Character.h"
-#include "embxx/io/InStreamBuf.h"
 #include "embxx/io/OutStreamBuf.h"
 #include "embxx/io/OutStream.h"
 #include "embxx/device/DeviceOpQueue.h"
@@ -35,6 +34,7 @@
 #include "device/Timer.h"
 #include "device/EventLoopDevices.h"
 #include "device/Uart1.h"
+#include "device/Dma.h"
 #include "device/Spi0.h"
 
 #include "component/OnBoardLed.h"
@@ -54,10 +54,13 @@ public:
 
     typedef device::Uart1<InterruptMgr> Uart;
 
+    typedef device::DmaChannel<InterruptMgr> DmaChannel;
+
     typedef device::Spi0<
         InterruptMgr,
         embxx::util::StaticFunction<void(), sizeof(void*) * 4>,
-        embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&)> > Spi;
+        embxx::util::StaticFunction<void(const embxx::error::ErrorStatus&)>,
+        DmaChannel> Spi;
 
     typedef embxx::device::DeviceOpQueue<Spi, 1> SpiOpQueue;
 
@@ -75,8 +78,6 @@ public:
 
     typedef embxx::driver::Character<CharSpiAdapter, EventLoop> SpiDriver;
 
-    typedef embxx::io::InStreamBuf<SpiDriver, 4096> SpiInStreamBuf;
-
     typedef component::OnBoardLed<Gpio> Led;
 
     static const std::size_t LogStreamBufSize = 4096 * 2;
@@ -106,8 +107,8 @@ public:
         return spiDriver_;
     }
 
-    SpiInStreamBuf& spiInBuf() {
-        return spiInBuf_;
+    Spi& spiDevice() {
+        return spi_;
     }
 
     // TODO: move to private
@@ -122,6 +123,8 @@ private:
     device::Function func_;
     Gpio gpio_;
     Uart uart_;
+    DmaChannel spiTxDma_;
+    DmaChannel spiRxDma_;
     Spi spi_;
     SpiOpQueue spiOpQueue_;
     CharSpiAdapter spiCharAdapter_;
@@ -135,10 +138,11 @@ private:
     LogStreamBuf buf_;
     OutStream stream_;
     Log log_;
-    SpiInStreamBuf spiInBuf_;
 
     static const unsigned SysClockFreq = 250000000; // 250MHz
     static const unsigned InitialSpiFreq = 200000; // 200KHz
+    static const std::size_t SpiTxDmaChannel = 4;
+    static const std::size_t SpiRxDmaChannel = 5;
 
 };
 
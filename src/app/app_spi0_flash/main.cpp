@@ -20,6 +20,7 @@
 #include <functional>
 #include <cstdint>
 #include <array>
+#include <algorithm>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StreamLogger.h"
@@ -60,6 +61,96 @@ private:
     Led& led_;
 };
 
+void performInit(unsigned attempt);
+
+void checkResponse(unsigned attempt, const embxx::error::ErrorStatus& es);
+
+void performOpCond(unsigned attempt);
+
+void readBlock(unsigned attempt);
+
+void checkBlock(unsigned attempt, const embxx::error::ErrorStatus& es);
+
+// Card responds to the command within 8 bytes
+const std::size_t ResponseSize = 8;
+std::array<std::uint8_t, ResponseSize> response;
+
+const std::size_t CommandSize = 6;
+const std::uint8_t R1Idle = 0x01;
+const std::uint8_t R1Ready = 0x00;
+const std::uint8_t DataStartToken = 0xfe;
+const std::size_t BlockSize = 512;
+const unsigned MaxAttempts = 100;
+
+// Block read is performed as single DMA transfer (chip select is held
+// active): command, response, wait for the data token, data and CRC.
+const std::size_t BlockReadWordsCount = 512;
+typedef std::array<System::Spi::DmaWordType, BlockReadWordsCount> BlockReadBuf;
+BlockReadBuf blockReadTx;
+BlockReadBuf blockReadRx;
+
+void waitBeforeRetry()
+{
+    for (volatile int i = 0; i < 1000000; ++i) {}
+}
+
+void postToEventLoop(void (*func)(unsigned), unsigned attempt)
+{
+    auto& el = System::instance().eventLoop();
+    auto result = el.post(std::bind(func, attempt));
+    GASSERT(result);
+    static_cast<void>(result);
+}
+
+void fillCommand(
+    std::uint8_t* buf,
+    std::uint8_t cmd,
+    std::uint32_t arg,
+    std::uint8_t crc)
+{
+    buf[0] = 0x40 | cmd;
+    buf[1] = static_cast<std::uint8_t>(arg >> 24);
+    buf[2] = static_cast<std::uint8_t>(arg >> 16);
+    buf[3] = static_cast<std::uint8_t>(arg >> 8);
+    buf[4] = static_cast<std::uint8_t>(arg);
+    buf[5] = crc;
+}
+
+const std::uint8_t* findR1(const std::uint8_t* begin, const std::uint8_t* end)
+{
+    return std::find_if(
+        begin,
+        end,
+        [](std::uint8_t byte) -> bool
+        {
+            return (byte & 0x80) == 0;
+        });
+}
+
+// Short command exchange fits into the FIFO and is performed by polling.
+std::uint8_t sendCommand(std::uint8_t cmd, std::uint32_t arg, std::uint8_t crc)
+{
+    std::array<std::uint8_t, CommandSize + ResponseSize> buf;
+    std::fill(buf.begin(), buf.end(), 0xff);
+    fillCommand(&buf[0], cmd, arg, crc);
+
+    auto& spi = System::instance().spiDevice();
+    auto done = spi.tryTransferPolled(
+        System::SpiDevIdx,
+        &buf[0],
+        &buf[0],
+        buf.size(),
+        embxx::device::context::EventLoop());
+    GASSERT(done);
+    static_cast<void>(done);
+
+    auto r1 = findR1(&buf[CommandSize], &buf[0] + buf.size());
+    if (r1 == (&buf[0] + buf.size())) {
+        return 0xff;
+    }
+    return *r1;
+}
+
 void performInit(unsigned attempt)
 {
     static const std::uint8_t Cmd0[] = {
@@ -70,41 +161,132 @@ void performInit(unsigned attempt)
 
     SLOG(System::instance().log(), embxx::util::log::Info, "Attempt " << attempt);
 
-    auto& spi = System::instance().spi();
-    spi.asyncWrite(
-        &Cmd0[0],
-        Cmd0Size,
-        [](const embxx::error::ErrorStatus& es, std::size_t bytesWritten)
+    // The command and the response are transferred with CS held active
+    const System::Spi::TransferPhase phases[] = {
+        {&Cmd0[0], nullptr, Cmd0Size},
+        {nullptr, &response[0], response.size()}
+    };
+
+    auto& spi = System::instance().spiDevice();
+    spi.setTransferCompleteHandler(
+        [attempt](const embxx::error::ErrorStatus& es)
         {
-            SLOG(System::instance().log(), embxx::util::log::Info, "Write complete!");
-            GASSERT(!es);
-            GASSERT(bytesWritten == Cmd0Size);
+            auto& el = System::instance().eventLoop();
+            auto result = el.postInterruptCtx(
+                std::bind(&checkResponse, attempt, es));
+            GASSERT(result);
+            static_cast<void>(result);
         });
 
-    auto& spiInBuf = System::instance().spiInBuf();
-    spiInBuf.start();
+    spi.startTransaction(
+        System::SpiDevIdx,
+        &phases[0],
+        std::extent<decltype(phases)>::value,
+        embxx::device::context::EventLoop());
+}
+
+void checkResponse(unsigned attempt, const embxx::error::ErrorStatus& es)
+{
+    SLOG(System::instance().log(), embxx::util::log::Info, "Transaction complete!");
+    GASSERT(!es);
+    auto r1 = findR1(&response[0], &response[0] + response.size());
+    if (r1 != (&response[0] + response.size())) {
+        SLOG(System::instance().log(), embxx::util::log::Info, "Byte=0x" << embxx::io::hex << (unsigned)*r1);
+        if (*r1 == R1Idle) {
+            postToEventLoop(&performOpCond, 0);
+        }
+        return;
+    }
+
+    waitBeforeRetry();
+    performInit(attempt + 1);
+}
 
-    static const unsigned DataBufSize = 128;
-    spiInBuf.asyncWaitDataAvailable(
-        DataBufSize,
-        [&spiInBuf, attempt](const embxx::error::ErrorStatus& es)
+void performOpCond(unsigned attempt)
+{
+    auto& log = System::instance().log();
+    if (attempt == 0) {
+        // SEND_IF_COND, voltage 2.7-3.6V, check pattern 0xaa
+        auto r1 = sendCommand(8, 0x1aa, 0x87);
+        SLOG(log, embxx::util::log::Info, "CMD8 R1=0x" << embxx::io::hex << (unsigned)r1);
+    }
+
+    // APP_CMD followed by SD_SEND_OP_COND with high capacity support
+    auto r1 = sendCommand(55, 0, 0x01);
+    if ((r1 & ~R1Idle) == 0) {
+        r1 = sendCommand(41, 0x40000000, 0x01);
+    }
+
+    if (r1 == R1Ready) {
+        SLOG(log, embxx::util::log::Info, "Card is ready after " << embxx::io::dec << attempt << " attempts");
+        postToEventLoop(&readBlock, 0);
+        return;
+    }
+
+    if (MaxAttempts <= attempt) {
+        SLOG(log, embxx::util::log::Error, "Card initialisation failed, R1=0x" << embxx::io::hex << (unsigned)r1);
+        return;
+    }
+
+    waitBeforeRetry();
+    postToEventLoop(&performOpCond, attempt + 1);
+}
+
+void readBlock(unsigned attempt)
+{
+    // READ_SINGLE_BLOCK of block 0 followed by the fill characters
+    auto* txBytes = reinterpret_cast<std::uint8_t*>(&blockReadTx[0]);
+    std::fill_n(txBytes, blockReadTx.size() * sizeof(blockReadTx[0]), 0xff);
+    fillCommand(txBytes, 17, 0, 0x01);
+
+    auto& spi = System::instance().spiDevice();
+    spi.setTransferCompleteHandler(
+        [attempt](const embxx::error::ErrorStatus& es)
         {
-            SLOG(System::instance().log(), embxx::util::log::Info, "Block");
-            GASSERT(!es);
-            spiInBuf.stop();
-            auto iter = spiInBuf.begin();
-            for (auto i = 0U; i < DataBufSize; ++i) {
-                auto byte = embxx::io::readBig<std::uint8_t>(iter);
-                if (byte != 0xff) {
-                    SLOG(System::instance().log(), embxx::util::log::Info, "Byte=0x" << embxx::io::hex << (unsigned)byte);
-                    return;
-                }
-            }
-            spiInBuf.consume();
-
-            for (volatile int i = 0; i < 1000000; ++i) {}
-            performInit(attempt + 1);
+            auto& el = System::instance().eventLoop();
+            auto result = el.postInterruptCtx(
+                std::bind(&checkBlock, attempt, es));
+            GASSERT(result);
+            static_cast<void>(result);
         });
+
+    spi.startDmaTransfer(
+        System::SpiDevIdx,
+        &blockReadTx[0],
+        &blockReadRx[0],
+        blockReadRx.size(),
+        embxx::device::context::EventLoop());
+}
+
+void checkBlock(unsigned attempt, const embxx::error::ErrorStatus& es)
+{
+    auto& log = System::instance().log();
+    GASSERT(!es);
+    static_cast<void>(es);
+
+    auto* begin = reinterpret_cast<const std::uint8_t*>(&blockReadRx[0]);
+    auto* end = begin + (blockReadRx.size() * sizeof(blockReadRx[0]));
+    auto* responseEnd = std::min(begin + CommandSize + ResponseSize, end);
+    auto* r1 = findR1(begin + CommandSize, responseEnd);
+    auto* token = end;
+    if ((r1 != responseEnd) && (*r1 == R1Ready)) {
+        token = std::find(r1 + 1, end, DataStartToken);
+    }
+
+    if ((token == end) ||
+        (static_cast<std::size_t>(end - token) < (1 + BlockSize + 2))) {
+        SLOG(log, embxx::util::log::Warning, "Block read failed, attempt " << embxx::io::dec << attempt);
+        if (attempt < MaxAttempts) {
+            waitBeforeRetry();
+            readBlock(attempt + 1);
+        }
+        return;
+    }
+
+    auto* data = token + 1;
+    SLOG(log, embxx::util::log::Info,
+        "Block 0 signature: 0x" << embxx::io::hex <<
+        (unsigned)data[BlockSize - 2] << " 0x" << (unsigned)data[BlockSize - 1]);
 }
 
 }  // namespace
@@ -125,8 +307,7 @@ int main() {
     for (volatile int i = 0; i < 5000000; ++i) {}
     led.off();
 
-    auto& spi = system.spi();
-    spi.device().device().device().setFillChar(0xff);
+    system.spiDevice().setFillChar(0xff);
 
     performInit(0);
 
@@ -136,7 +317,6 @@ int main() {
 
     // TODO: problems:
     // 1. Need to wait 1ms before sending
-    // 2. Removing CS every 16
 
     GASSERT(0); // Mustn't exit
 	return 0;
@@ -26,6 +26,9 @@
 #include "message/ButtonStateChangeMsg.h"
 #include "message/LedStateChangeMsg.h"
 #include "message/LedStateCtrlMsg.h"
+#include "message/InterruptLatencyMsg.h"
+#include "message/BaudRateReqMsg.h"
+#include "message/BaudRateRspMsg.h"
 
 template <typename THandler, typename TTraits>
 struct AllMsgsDefs
@@ -36,12 +39,18 @@ struct AllMsgsDefs
     typedef message::ButtonStateChangeMsg<MsgBase> ButtonStateChangeMsg;
     typedef message::LedStateChangeMsg<MsgBase> LedStateChangeMsg;
     typedef message::LedStateCtrlMsg<MsgBase> LedStateCtrlMsg;
+    typedef message::InterruptLatencyMsg<MsgBase> InterruptLatencyMsg;
+    typedef message::BaudRateReqMsg<MsgBase> BaudRateReqMsg;
+    typedef message::BaudRateRspMsg<MsgBase> BaudRateRspMsg;
 
     typedef std::tuple<
         HeartbeatMsg,
         ButtonStateChangeMsg,
         LedStateChangeMsg,
-        LedStateCtrlMsg
+        LedStateCtrlMsg,
+        InterruptLatencyMsg,
+        BaudRateReqMsg,
+        BaudRateRspMsg
     > AllMsgs;
 };
 
@@ -0,0 +1,141 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+#include "embxx/util/Assert.h"
+
+#include "device/InterruptMgr.h"
+
+/// @brief Periodic interrupt of the system timer compare channel 1, that
+///        measures its own latency.
+/// @details The latency is the time elapsed from the compare match until
+///          the invocation of the handler, with 1us resolution. The handler
+///          never accesses the event loop, i.e. the source doesn't need
+///          to be masked by the event loop lock (see
+///          InterruptMgr::setLockable()).
+template <typename TInterruptMgr>
+class LatencyProbe
+{
+public:
+    typedef TInterruptMgr InterruptMgr;
+    typedef std::uint32_t TicksType;
+
+    explicit LatencyProbe(InterruptMgr& interruptMgr);
+
+    /// @brief Start periodic interrupts.
+    /// @param periodUs Period in microseconds.
+    void start(TicksType periodUs);
+
+    void stop();
+
+    /// @brief Retrieve the longest latency (in microseconds) and restart
+    ///        the measurement.
+    TicksType takeMaxLatency();
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor.
+    void interruptHandler();
+
+private:
+    typedef std::uint32_t EntryType;
+
+    void arm(EntryType compareValue);
+
+    InterruptMgr& interruptMgr_;
+    TicksType periodUs_;
+    volatile TicksType maxLatency_;
+
+    // System timer, counts microseconds
+    static constexpr volatile EntryType* const CsReg =
+        reinterpret_cast<volatile EntryType*>(0x20003000);
+
+    static constexpr const volatile EntryType* const CloReg =
+        reinterpret_cast<const volatile EntryType*>(0x20003004);
+
+    static constexpr volatile EntryType* const C1Reg =
+        reinterpret_cast<volatile EntryType*>(0x20003010);
+
+    static const std::size_t Match1Pos = 1;
+    static const EntryType Match1Mask =
+        static_cast<EntryType>(1) << Match1Pos;
+};
+
+// Implementation
+
+template <typename TInterruptMgr>
+LatencyProbe<TInterruptMgr>::LatencyProbe(InterruptMgr& interruptMgr)
+    : interruptMgr_(interruptMgr),
+      periodUs_(0),
+      maxLatency_(0)
+{
+    interruptMgr_.registerHandler(
+        InterruptMgr::IrqId_SystemTimer1,
+        std::bind(&LatencyProbe::interruptHandler, this));
+}
+
+template <typename TInterruptMgr>
+void LatencyProbe<TInterruptMgr>::start(TicksType periodUs)
+{
+    GASSERT(0 < periodUs);
+    periodUs_ = periodUs;
+    arm(*CloReg + periodUs_);
+    interruptMgr_.enableInterrupt(InterruptMgr::IrqId_SystemTimer1);
+}
+
+template <typename TInterruptMgr>
+void LatencyProbe<TInterruptMgr>::stop()
+{
+    interruptMgr_.disableInterrupt(InterruptMgr::IrqId_SystemTimer1);
+    *CsReg = Match1Mask;
+}
+
+template <typename TInterruptMgr>
+typename LatencyProbe<TInterruptMgr>::TicksType
+LatencyProbe<TInterruptMgr>::takeMaxLatency()
+{
+    auto flags = device::interrupt::save();
+    device::interrupt::disable();
+    TicksType value = maxLatency_;
+    maxLatency_ = 0;
+    device::interrupt::restore(flags);
+    return value;
+}
+
+template <typename TInterruptMgr>
+void LatencyProbe<TInterruptMgr>::interruptHandler()
+{
+    auto now = *CloReg;
+    auto latency = static_cast<TicksType>(now - *C1Reg);
+    if (maxLatency_ < latency) {
+        maxLatency_ = latency;
+    }
+
+    arm(now + periodUs_);
+}
+
+template <typename TInterruptMgr>
+void LatencyProbe<TInterruptMgr>::arm(EntryType compareValue)
+{
+    *C1Reg = compareValue;
+    *CsReg = Match1Mask; // Clear previous match
+}
+
@@ -0,0 +1,86 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include "device/FreeRunningCounter.h"
+
+/// @brief Wrapper around event loop lock, which records the longest
+///        duration the lock was held.
+/// @details The duration is measured using device::FreeRunningCounter,
+///          which must be enabled. The time spent in the wait condition
+///          is not included as long as the condition releases the lock
+///          while waiting (see device::SelectiveWaitCond).
+template <typename TLock>
+class MeasuredLock
+{
+public:
+    typedef device::FreeRunningCounter::TicksType TicksType;
+
+    void lock()
+    {
+        lock_.lock();
+        startTicks_ = device::FreeRunningCounter::ticks();
+    }
+
+    void unlock()
+    {
+        updateMax(startTicks_);
+        lock_.unlock();
+    }
+
+    void lockInterruptCtx()
+    {
+        lock_.lockInterruptCtx();
+        ctxStartTicks_ = device::FreeRunningCounter::ticks();
+    }
+
+    void unlockInterruptCtx()
+    {
+        updateMax(ctxStartTicks_);
+        lock_.unlockInterruptCtx();
+    }
+
+    /// @brief Retrieve the longest lock duration and restart the measurement.
+    static TicksType takeMaxTicks()
+    {
+        TicksType value = maxTicks_;
+        maxTicks_ = 0;
+        return value;
+    }
+
+private:
+    static void updateMax(TicksType startTicks)
+    {
+        auto duration = device::FreeRunningCounter::ticks() - startTicks;
+        if (maxTicks_ < duration) {
+            maxTicks_ = duration;
+        }
+    }
+
+    TLock lock_;
+    TicksType startTicks_;
+    TicksType ctxStartTicks_;
+    static volatile TicksType maxTicks_;
+};
+
+// Implementation
+
+template <typename TLock>
+volatile typename MeasuredLock<TLock>::TicksType MeasuredLock<TLock>::maxTicks_ = 0;
+
@@ -28,15 +28,30 @@ namespace
 
 const auto HeartbeatPeriod = std::chrono::seconds(2);
 
+// Host is expected to send its messages (heartbeats) at the same rate
+const auto LinkTimeout = HeartbeatPeriod * 3;
+
+const auto BaudSwitchPollPeriod = std::chrono::milliseconds(10);
+
+// Leaves the other half of the ~5% tolerated by 10 bits characters to
+// the host side.
+const unsigned MaxBaudErrorPpm = 20000;
+
 }  // namespace
 
 Session::Session(System& system)
     : system_(system),
       heartbeatTimer_(system_.timerMgr().allocTimer()),
       protStack_(SyncPrefixType(SyncPrefixValue)),
-      heartbeatSeqNumValue_(0)
+      heartbeatSeqNumValue_(0),
+      linkTimer_(system_.timerMgr().allocTimer()),
+      pendingBaud_(0),
+      baudSwitchPending_(false),
+      deferredStateChangesCount_(0),
+      inBufSize_(0)
 {
     GASSERT(heartbeatTimer_.isValid());
+    GASSERT(linkTimer_.isValid());
     scheduleHeartbeat();
 
     auto& button = system_.button();
@@ -52,9 +67,7 @@ Session::Session(System& system)
             this,
             message::ButtonStateChangeMsgButtonState::Released));
 
-    system_.commsInStreamBuf().start();
     startRead();
-
 }
 
 void Session::handleMessage(const LedStateCtrlMsg& msg)
@@ -72,6 +85,37 @@ void Session::handleMessage(const LedStateCtrlMsg& msg)
     }
 }
 
+void Session::handleMessage(const BaudRateReqMsg& msg)
+{
+    static const auto BaudIdx = message::BaudRateReqMsgFieldIdx_Baud;
+    auto baud = std::get<BaudIdx>(msg.getFields()).getValue();
+    auto& uart = system_.uart();
+
+    auto status = message::BaudRateRspMsgStatus::Rejected;
+    if ((!baudSwitchPending_) &&
+        (uart.getBaudErrorPpm(baud) <= MaxBaudErrorPpm)) {
+        status = message::BaudRateRspMsgStatus::Accepted;
+    }
+
+    // The response is sent with the current baud rate
+    auto fields = BaudRateRspMsg::Fields(
+        BaudRateRspMsg::BaudField(baud),
+        BaudRateRspMsg::StatusField(status));
+    BaudRateRspMsg rsp(fields);
+    sendMessage(rsp);
+
+    if ((status != message::BaudRateRspMsgStatus::Accepted) ||
+        (baud == uart.getBaud())) {
+        return;
+    }
+
+    // Nothing else is sent until the switch to make it happen
+    // at the frame boundary
+    pendingBaud_ = baud;
+    baudSwitchPending_ = true;
+    startLinkTimer(BaudSwitchPollPeriod);
+}
+
 void Session::handleMessage(const MsgBase& msg)
 {
     static_cast<void>(msg);
@@ -79,6 +123,13 @@ void Session::handleMessage(const MsgBase& msg)
 
 void Session::buttonStateChanged(message::ButtonStateChangeMsgButtonState state)
 {
+    if (baudSwitchPending_) {
+        deferStateChange(
+            message::MsgId_ButtonStateChange,
+            static_cast<unsigned>(state));
+        return;
+    }
+
     auto fields = ButtonStateChangeMsg::Fields(
         ButtonStateChangeMsg::StateField(state));
     ButtonStateChangeMsg msg(fields);
@@ -87,6 +138,13 @@ void Session::buttonStateChanged(message::ButtonStateChangeMsgButtonState state)
 
 void Session::ledStateChanged(message::LedStateChangeMsgLedState state)
 {
+    if (baudSwitchPending_) {
+        deferStateChange(
+            message::MsgId_LedStateChange,
+            static_cast<unsigned>(state));
+        return;
+    }
+
     auto fields = LedStateChangeMsg::Fields(
         LedStateChangeMsg::StateField(state));
     LedStateChangeMsg msg(fields);
@@ -105,6 +163,7 @@ void Session::scheduleHeartbeat()
             }
 
             sendHeartbeat();
+            sendInterruptLatency();
             scheduleHeartbeat();
         });
 }
@@ -119,8 +178,39 @@ void Session::sendHeartbeat()
     ++heartbeatSeqNumValue_;
 }
 
+void Session::sendInterruptLatency()
+{
+    auto& interruptMgr = system_.interruptMgr();
+    InterruptLatencyMsg::MaskedSourcesField::ValueType maskedSources = 0;
+    static_assert(
+        System::InterruptMgr::IrqId_NumOfIds <= (sizeof(maskedSources) * 8),
+        "Masked sources field is too short");
+    for (auto id = 0U; id < System::InterruptMgr::IrqId_NumOfIds; ++id) {
+        auto irqId = static_cast<System::InterruptMgr::IrqId>(id);
+        if ((!System::SelectiveLocking) || interruptMgr.isLockable(irqId)) {
+            maskedSources |= static_cast<decltype(maskedSources)>(1U << id);
+        }
+    }
+
+    auto fields = InterruptLatencyMsg::Fields(
+        InterruptLatencyMsg::MaxMaskedTicksField(
+            System::EventLoopLock::takeMaxTicks()),
+        InterruptLatencyMsg::MaskedSourcesField(maskedSources),
+        InterruptLatencyMsg::MaxProbeLatencyField(
+            system_.probe().takeMaxLatency()));
+
+    InterruptLatencyMsg msg(fields);
+    sendMessage(msg);
+}
+
 void Session::sendMessage(const MsgBase& msg)
 {
+    if (baudSwitchPending_) {
+        // Periodic message dropped, the state changes are deferred
+        // by the callers
+        return;
+    }
+
     auto& buf = system_.commsOutStreamBuf();
     GASSERT(buf.empty());
     auto writeIter = std::back_inserter(buf);
@@ -139,59 +229,157 @@ void Session::sendMessage(const MsgBase& msg)
     buf.flush();
 }
 
-void Session::startRead()
+void Session::deferStateChange(message::MsgId id, unsigned state)
+{
+    GASSERT(baudSwitchPending_);
+    if (deferredStateChangesCount_ == deferredStateChanges_.size()) {
+        // The host is expected to complete the switch within few
+        // milliseconds, keep the latest changes.
+        std::move(
+            deferredStateChanges_.begin() + 1,
+            deferredStateChanges_.end(),
+            deferredStateChanges_.begin());
+        --deferredStateChangesCount_;
+    }
+
+    auto& stateChange = deferredStateChanges_[deferredStateChangesCount_];
+    stateChange.id_ = id;
+    stateChange.state_ = state;
+    ++deferredStateChangesCount_;
+}
+
+void Session::sendDeferredStateChanges()
+{
+    GASSERT(!baudSwitchPending_);
+    for (auto idx = 0U; idx < deferredStateChangesCount_; ++idx) {
+        auto& stateChange = deferredStateChanges_[idx];
+        if (stateChange.id_ == message::MsgId_ButtonStateChange) {
+            buttonStateChanged(
+                static_cast<message::ButtonStateChangeMsgButtonState>(
+                    stateChange.state_));
+            continue;
+        }
+
+        GASSERT(stateChange.id_ == message::MsgId_LedStateChange);
+        ledStateChanged(
+            static_cast<message::LedStateChangeMsgLedState>(
+                stateChange.state_));
+    }
+    deferredStateChangesCount_ = 0;
+}
+
+void Session::restartLinkTimer()
 {
-    scheduleRead(protStack_.length());
+    if (baudSwitchPending_) {
+        return;
+    }
+
+    startLinkTimer(LinkTimeout);
 }
 
-void Session::scheduleRead(std::size_t length)
+void Session::startLinkTimer(std::chrono::milliseconds timeout)
 {
-    auto& buf = system_.commsInStreamBuf();
-    buf.asyncWaitDataAvailable(
-        length,
-        std::bind(&Session::readHandler, this, std::placeholders::_1));
+    linkTimer_.cancel();
+    linkTimer_.asyncWait(
+        timeout,
+        [this](const embxx::error::ErrorStatus& err)
+        {
+            if (err) {
+                return;
+            }
+
+            linkTimerExpired();
+        });
 }
 
-void Session::readHandler(const embxx::error::ErrorStatus& err)
+void Session::linkTimerExpired()
 {
-    if (err == embxx::error::ErrorCode::Aborted) {
+    auto& uart = system_.uart();
+    if (!baudSwitchPending_) {
+        // Host is gone or failed to switch
+        if (uart.getBaud() != System::UartDefaultBaud) {
+            uart.configBaud(System::UartDefaultBaud);
+        }
         return;
     }
 
-    if (err) {
-        // Retry
-        startRead();
+    if ((!system_.commsOutStreamBuf().empty()) || (!uart.isWriteIdle())) {
+        // The response is still being transmitted
+        startLinkTimer(BaudSwitchPollPeriod);
         return;
     }
 
-    auto& buf = system_.commsInStreamBuf();
-    while (true) {
-        if (buf.empty()) {
-            startRead();
-            return;
-        }
+    uart.configBaud(pendingBaud_);
+    baudSwitchPending_ = false;
+    restartLinkTimer();
+    sendDeferredStateChanges();
+}
+
+void Session::startRead()
+{
+    GASSERT(inBufSize_ < inBuf_.size());
+    system_.uartDriver().asyncRead(
+        &inBuf_[inBufSize_],
+        inBuf_.size() - inBufSize_,
+        std::bind(
+            &Session::readHandler,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2));
+}
 
+void Session::readHandler(
+    const embxx::error::ErrorStatus& err,
+    std::size_t bytesRead)
+{
+    if (err == embxx::error::ErrorCode::Aborted) {
+        return;
+    }
+
+    // The read completes when the line becomes idle, i.e. usually with
+    // the whole frame received.
+    GASSERT(bytesRead <= (inBuf_.size() - inBufSize_));
+    inBufSize_ += bytesRead;
+    processInput();
+    startRead();
+}
+
+void Session::processInput()
+{
+    std::size_t consumed = 0;
+    while (consumed < inBufSize_) {
+        auto readIter = static_cast<ReadIterator>(&inBuf_[consumed]);
+        auto remSize = inBufSize_ - consumed;
         std::size_t missingSize = 0;
-        auto readIter = buf.begin();
         MsgPtr msg;
-        auto readStatus = protStack_.read(msg, readIter, buf.size(), &missingSize);
+        auto readStatus = protStack_.read(msg, readIter, remSize, &missingSize);
         if (readStatus == embxx::comms::ErrorStatus::NotEnoughData) {
-            GASSERT(0 < missingSize);
-            auto nextSize = std::min(buf.size() + missingSize, buf.fullCapacity());
-            scheduleRead(nextSize);
-            return;
+            break;
         }
 
         if (readStatus != embxx::comms::ErrorStatus::Success) {
-            buf.consume(1U);
+            ++consumed;
             continue;
         }
 
         GASSERT(msg);
-        auto lengthToConsume =
-            static_cast<std::size_t>(std::distance(buf.begin(), readIter));
+        auto lengthToConsume = static_cast<std::size_t>(
+            std::distance(static_cast<ReadIterator>(&inBuf_[consumed]), readIter));
         GASSERT(0 < lengthToConsume);
-        buf.consume(lengthToConsume);
+        consumed += lengthToConsume;
+        restartLinkTimer();
         msg->dispatch(*this);
     }
+
+    if ((consumed == 0) && (inBufSize_ == inBuf_.size())) {
+        // Can't happen with valid frames, all of them fit into the buffer
+        consumed = inBufSize_;
+    }
+
+    // Keep the incomplete frame at the beginning of the buffer
+    std::copy(
+        inBuf_.begin() + consumed,
+        inBuf_.begin() + inBufSize_,
+        inBuf_.begin());
+    inBufSize_ -= consumed;
 }
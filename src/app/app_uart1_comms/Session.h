@@ -21,6 +21,8 @@
 #include <cstdint>
 #include <iterator>
 #include <tuple>
+#include <array>
+#include <chrono>
 
 #include "embxx/comms/Message.h"
 #include "embxx/comms/protocol.h"
@@ -33,7 +35,7 @@
 struct CommsTraits {
     typedef embxx::comms::traits::endian::Big Endianness;
     typedef embxx::comms::traits::checksum::VerifyAfterProcessing ChecksumVerification;
-    typedef System::CommsInStreamBuf::ConstIterator ReadIterator;
+    typedef const System::Uart::CharType* ReadIterator;
     typedef std::back_insert_iterator<System::CommsOutStreamBuf> WriteIterator;
     static const std::size_t MsgIdLen = 1;
     static const std::size_t MsgSizeLen = 1;
@@ -59,10 +61,10 @@ public:
     Session& operator=(Session&&) = delete;
 
     void handleMessage(const LedStateCtrlMsg& msg);
+    void handleMessage(const BaudRateReqMsg& msg);
     void handleMessage(const MsgBase& msg);
 
 private:
-    typedef System::CommsInStreamBuf CommsInStreamBuf;
     typedef System::CommsOutStreamBuf CommsOutStreamBuf;
 
     typedef embxx::comms::protocol::MsgDataLayer<MsgBase> MsgDataLayer;
@@ -97,16 +99,47 @@ private:
     void ledStateChanged(message::LedStateChangeMsgLedState state);
     void scheduleHeartbeat();
     void sendHeartbeat();
+    void sendInterruptLatency();
     void sendMessage(const MsgBase& msg);
+    void deferStateChange(message::MsgId id, unsigned state);
+    void sendDeferredStateChanges();
+    void restartLinkTimer();
+    void startLinkTimer(std::chrono::milliseconds timeout);
+    void linkTimerExpired();
     void startRead();
-    void scheduleRead(std::size_t lenth);
-    void readHandler(const embxx::error::ErrorStatus& status);
+    void readHandler(
+        const embxx::error::ErrorStatus& status,
+        std::size_t bytesRead);
+    void processInput();
 
     System& system_;
     Timer heartbeatTimer_;
     ProtocolStack protStack_;
     HeartbeatMsg::SeqNumField::ValueType heartbeatSeqNumValue_;
 
+    // Baud rate negotiation, the switch is performed when the response
+    // has been fully transmitted, the link falls back to the default
+    // baud rate when no messages are received from the host.
+    Timer linkTimer_;
+    unsigned pendingBaud_;
+    bool baudSwitchPending_;
+
+    // State changes reported during pending baud switch, sent after it.
+    // The periodic messages are not deferred.
+    struct StateChange
+    {
+        message::MsgId id_;
+        unsigned state_;
+    };
+    static const std::size_t MaxDeferredStateChanges = 8;
+    std::array<StateChange, MaxDeferredStateChanges> deferredStateChanges_;
+    std::size_t deferredStateChangesCount_;
+
+    // Received data, the read completes on idle line (end of frame)
+    static const std::size_t InBufSize = 512;
+    std::array<System::Uart::CharType, InBufSize> inBuf_;
+    std::size_t inBufSize_;
+
     typedef SyncPrefixLayer::SyncPrefixType SyncPrefixType;
     static const SyncPrefixType SyncPrefixValue = 0x4869; // "Hi" in ascii
 };
@@ -17,6 +17,15 @@
 
 #include "System.h"
 
+namespace
+{
+
+// Used by FIQ handler, bypassing the construction guard of
+// System::instance() and the interrupt manager dispatch.
+System::Uart* fiqUart = nullptr;
+
+}  // namespace
+
 System& System::instance()
 {
     static System system;
@@ -27,15 +36,34 @@ System::System()
     : gpio_(interruptMgr_, func_),
       uart_(interruptMgr_, func_, SysClockFreq),
       timerDevice_(interruptMgr_),
+      probe_(interruptMgr_),
       buttonDriver_(gpio_, el_),
       uartDriver_(uart_, el_),
       timerMgr_(timerDevice_, el_),
       led_(gpio_),
       button_(buttonDriver_, ButtonPin),
-      commsInStreamBuf_(uartDriver_),
       commsOutStreamBuf_(uartDriver_)
 {
-    uart_.configBaud(UartBaud);
+    // Used to measure duration of event loop locking
+    device::FreeRunningCounter::enable();
+    device::SelectiveInterruptLock<InterruptMgr>::setInterruptMgr(interruptMgr_);
+
+    // UART is the latency critical telemetry link, it is the only user
+    // of the AUX interrupt (no AuxInterruptMgr).
+    fiqUart = &uart_;
+    interruptMgr_.routeToFiq(InterruptMgr::IrqId_AuxInt);
+
+    // The probe never posts to the event loop, it keeps running while
+    // the event loop lock is held (when SelectiveLocking is used).
+    interruptMgr_.setLockable(InterruptMgr::IrqId_SystemTimer1, false);
+    probe_.start(ProbePeriodUs);
+
+    uart_.configBaud(UartDefaultBaud);
+    // GPIO16 (CTS) drives the led, only RTS is used to prevent RX FIFO
+    // overflow
+    uart_.configFlowControl(true, false);
+    // Reads complete at the end of every frame
+    uart_.setReadIdleTimeout(UartReadIdleCharTimes);
     uart_.setReadEnabled(true);
     uart_.setWriteEnabled(true);
 }
@@ -46,3 +74,11 @@ void interruptHandler()
 {
     System::instance().interruptMgr().handleInterrupt();
 }
+
+extern "C"
+void fastInterruptHandler()
+{
+    // Bound directly to the UART handler, no statistics are collected
+    GASSERT(fiqUart != nullptr);
+    fiqUart->interruptHandler();
+}
@@ -17,12 +17,13 @@
 
 #pragma once
 
+#include <type_traits>
+
 #include "embxx/util/EventLoop.h"
 #include "embxx/driver/Character.h"
 #include "embxx/driver/Gpio.h"
 #include "embxx/driver/TimerMgr.h"
 #include "embxx/io/OutStreamBuf.h"
-#include "embxx/io/InStreamBuf.h"
 
 #include "device/Function.h"
 #include "device/Gpio.h"
@@ -30,24 +31,48 @@
 #include "device/Timer.h"
 #include "device/EventLoopDevices.h"
 #include "device/Uart1.h"
+#include "device/FreeRunningCounter.h"
 
 #include "component/OnBoardLed.h"
 #include "component/Button.h"
 
+#include "MeasuredLock.h"
+#include "LatencyProbe.h"
+
 class System
 {
 public:
+    typedef device::InterruptMgr<> InterruptMgr;
+
+    // Event loop masks only the interrupt sources posting to it, the
+    // duration of the masking is measured. Set to false to disable all
+    // the interrupts instead and compare the reported latency of the
+    // LatencyProbe, which doesn't post to the event loop.
+    static const bool SelectiveLocking = true;
+
+    typedef MeasuredLock<
+        std::conditional<
+            SelectiveLocking,
+            device::SelectiveInterruptLock<InterruptMgr>,
+            device::NestedInterruptLock // UART handler runs in FIQ
+        >::type
+    > EventLoopLock;
+    typedef std::conditional<
+        SelectiveLocking,
+        device::SelectiveWaitCond,
+        device::WaitCond
+    >::type EventLoopWaitCond;
     static const std::size_t EventLoopSpaceSize = 1024;
     typedef embxx::util::EventLoop<
         EventLoopSpaceSize,
-        device::InterruptLock,
-        device::WaitCond> EventLoop;
+        EventLoopLock,
+        EventLoopWaitCond> EventLoop;
 
     // Devices
-    typedef device::InterruptMgr<> InterruptMgr;
     typedef device::Gpio<InterruptMgr> Gpio;
     typedef device::Uart1<InterruptMgr> Uart;
     typedef device::Timer<InterruptMgr> TimerDevice;
+    typedef LatencyProbe<InterruptMgr> Probe;
 
     // Drivers
     typedef embxx::driver::Gpio<Gpio, EventLoop, 1> ButtonDriver;
@@ -55,7 +80,7 @@ public:
     typedef embxx::driver::TimerMgr<
             TimerDevice,
             EventLoop,
-            1> TimerMgr;
+            2> TimerMgr;
 
     // Components
     typedef component::OnBoardLed<Gpio> Led;
@@ -63,9 +88,12 @@ public:
         ButtonDriver,
         false,
         embxx::util::StaticFunction<void(), sizeof(void*) * 4> > Button;
-    typedef embxx::io::InStreamBuf<UartDriver, 1024> CommsInStreamBuf;
     typedef embxx::io::OutStreamBuf<UartDriver, 1024> CommsOutStreamBuf;
 
+    // The link always comes up with this baud rate, higher one may be
+    // negotiated at runtime (see Session).
+    static const unsigned UartDefaultBaud = 115200;
+
     static System& instance();
 
     inline EventLoop& eventLoop();
@@ -75,8 +103,9 @@ public:
     inline Led& led();
     inline Button& button();
     inline TimerDevice& timerDevice();
+    inline Probe& probe();
     inline TimerMgr& timerMgr();
-    inline CommsInStreamBuf& commsInStreamBuf();
+    inline UartDriver& uartDriver();
     inline CommsOutStreamBuf& commsOutStreamBuf();
 
 private:
@@ -90,6 +119,7 @@ private:
     Gpio gpio_;
     Uart uart_;
     TimerDevice timerDevice_;
+    Probe probe_;
 
     // Drivers
     ButtonDriver buttonDriver_;
@@ -99,17 +129,20 @@ private:
     // Components
     Led led_;
     Button button_;
-    CommsInStreamBuf commsInStreamBuf_;
     CommsOutStreamBuf commsOutStreamBuf_;
 
     static const unsigned SysClockFreq = 250000000; // 250MHz
     static const device::Function::PinIdxType ButtonPin = 23;
-    static const unsigned UartBaud = 115200;
+    static const unsigned UartReadIdleCharTimes = 4;
+    static const Probe::TicksType ProbePeriodUs = 1000;
 };
 
 extern "C"
 void interruptHandler();
 
+extern "C"
+void fastInterruptHandler();
+
 // Implementation
 
 inline
@@ -154,6 +187,12 @@ System::TimerDevice& System::timerDevice()
     return timerDevice_;
 }
 
+inline
+System::Probe& System::probe()
+{
+    return probe_;
+}
+
 inline
 System::TimerMgr& System::timerMgr()
 {
@@ -161,9 +200,9 @@ System::TimerMgr& System::timerMgr()
 }
 
 inline
-System::CommsInStreamBuf& System::commsInStreamBuf()
+System::UartDriver& System::uartDriver()
 {
-    return commsInStreamBuf_;
+    return uartDriver_;
 }
 
 inline
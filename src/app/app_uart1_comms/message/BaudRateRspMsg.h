@@ -0,0 +1,91 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <tuple>
+#include <cstdint>
+
+#include "embxx/comms/Message.h"
+#include "embxx/comms/field/BasicIntValue.h"
+#include "embxx/comms/field/BasicEnumValue.h"
+
+#include "MsgId.h"
+
+namespace message
+{
+
+enum BaudRateRspMsgFieldIdx {
+    BaudRateRspMsgFieldIdx_Baud,
+    BaudRateRspMsgFieldIdx_Status
+};
+
+enum class BaudRateRspMsgStatus {
+    Accepted,
+    Rejected,
+    NumOfStatuses
+};
+
+
+template <typename TTraits>
+struct BaudRateRspMsgFields {
+    typedef std::tuple<
+        embxx::comms::field::BasicIntValue<std::uint32_t, TTraits>,
+        embxx::comms::field::BasicEnumValue<BaudRateRspMsgStatus, TTraits, 1, BaudRateRspMsgStatus::NumOfStatuses>
+    > Type;
+};
+
+template <typename TBase>
+class BaudRateRspMsg :
+    public embxx::comms::MetaMessageBase<
+        MsgId_BaudRateRsp,
+        TBase,
+        BaudRateRspMsg<TBase>,
+        typename BaudRateRspMsgFields<typename TBase::Traits>::Type
+    >
+{
+    typedef
+        embxx::comms::MetaMessageBase<
+            MsgId_BaudRateRsp,
+            TBase,
+            BaudRateRspMsg<TBase>,
+            typename BaudRateRspMsgFields<typename TBase::Traits>::Type
+        > Base;
+public:
+    typedef typename Base::Traits Traits;
+    typedef typename Base::Fields Fields;
+
+    typedef typename std::tuple_element<BaudRateRspMsgFieldIdx_Baud, Fields>::type BaudField;
+    typedef typename std::tuple_element<BaudRateRspMsgFieldIdx_Status, Fields>::type StatusField;
+
+    BaudRateRspMsg() = default;
+    BaudRateRspMsg(const BaudRateRspMsg&) = default;
+    BaudRateRspMsg(const Fields& fields);
+    ~BaudRateRspMsg() = default;
+
+    BaudRateRspMsg& operator=(const BaudRateRspMsg&) = default;
+};
+
+// Implementation
+template <typename TBase>
+BaudRateRspMsg<TBase>::BaudRateRspMsg(const Fields& fields)
+    : Base(fields)
+{
+}
+
+}  // namespace message
@@ -0,0 +1,87 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <tuple>
+#include <cstdint>
+
+#include "embxx/comms/Message.h"
+#include "embxx/comms/field/BasicIntValue.h"
+
+#include "MsgId.h"
+
+namespace message
+{
+
+enum InterruptLatencyMsgFieldIdx {
+    InterruptLatencyMsgFieldIdx_MaxMaskedTicks,
+    InterruptLatencyMsgFieldIdx_MaskedSources,
+    InterruptLatencyMsgFieldIdx_MaxProbeLatency
+};
+
+
+template <typename TTraits>
+struct InterruptLatencyMsgFields {
+    typedef std::tuple<
+        embxx::comms::field::BasicIntValue<std::uint32_t, TTraits>,
+        embxx::comms::field::BasicIntValue<std::uint16_t, TTraits>,
+        embxx::comms::field::BasicIntValue<std::uint32_t, TTraits>
+    > Type;
+};
+
+template <typename TBase>
+class InterruptLatencyMsg :
+    public embxx::comms::MetaMessageBase<
+        MsgId_InterruptLatency,
+        TBase,
+        InterruptLatencyMsg<TBase>,
+        typename InterruptLatencyMsgFields<typename TBase::Traits>::Type
+    >
+{
+    typedef
+        embxx::comms::MetaMessageBase<
+            MsgId_InterruptLatency,
+            TBase,
+            InterruptLatencyMsg<TBase>,
+            typename InterruptLatencyMsgFields<typename TBase::Traits>::Type
+        > Base;
+public:
+    typedef typename Base::Traits Traits;
+    typedef typename Base::Fields Fields;
+
+    typedef typename std::tuple_element<InterruptLatencyMsgFieldIdx_MaxMaskedTicks, Fields>::type MaxMaskedTicksField;
+    typedef typename std::tuple_element<InterruptLatencyMsgFieldIdx_MaskedSources, Fields>::type MaskedSourcesField;
+    typedef typename std::tuple_element<InterruptLatencyMsgFieldIdx_MaxProbeLatency, Fields>::type MaxProbeLatencyField;
+
+    InterruptLatencyMsg() = default;
+    InterruptLatencyMsg(const InterruptLatencyMsg&) = default;
+    InterruptLatencyMsg(const Fields& fields);
+    ~InterruptLatencyMsg() = default;
+
+    InterruptLatencyMsg& operator=(const InterruptLatencyMsg&) = default;
+};
+
+// Implementation
+template <typename TBase>
+InterruptLatencyMsg<TBase>::InterruptLatencyMsg(const Fields& fields)
+    : Base(fields)
+{
+}
+
+}  // namespace message
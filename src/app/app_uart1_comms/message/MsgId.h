@@ -25,7 +25,10 @@ enum MsgId {
     MsgId_Heartbeat,
     MsgId_ButtonStateChange,
     MsgId_LedStateChange,
-    MsgId_LedStateCtrl
+    MsgId_LedStateCtrl,
+    MsgId_InterruptLatency,
+    MsgId_BaudRateReq,
+    MsgId_BaudRateRsp
 };
 
 }  // namespace message
@@ -31,6 +31,21 @@ System::System()
 {
 }
 
+void uartInterruptHandler()
+{
+    System::instance().uart().interruptHandler();
+}
+
+void uartIdleTimerInterruptHandler()
+{
+    System::instance().uart().idleTimerInterruptHandler();
+}
+
+void gpioInterruptHandler()
+{
+    System::instance().gpio().interruptHandler();
+}
+
 extern "C"
 void interruptHandler()
 {
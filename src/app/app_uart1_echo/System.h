@@ -22,13 +22,18 @@
 
 #include "device/Function.h"
 #include "device/Gpio.h"
-#include "device/InterruptMgr.h"
+#include "device/StaticInterruptMgr.h"
 #include "device/Timer.h"
 #include "device/EventLoopDevices.h"
 #include "device/Uart1.h"
 
 #include "component/OnBoardLed.h"
 
+// Interrupt handlers bound at compile time, defined in System.cpp
+void uartInterruptHandler();
+void uartIdleTimerInterruptHandler();
+void gpioInterruptHandler();
+
 class System
 {
 public:
@@ -38,7 +43,27 @@ public:
         device::InterruptLock,
         device::WaitCond> EventLoop;
 
-    typedef device::InterruptMgr<> InterruptMgr;
+    // Every source registered by the devices must be bound
+    typedef device::StaticInterruptMgr<
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_AuxInt,
+            &uartInterruptHandler>,
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_SystemTimer3,
+            &uartIdleTimerInterruptHandler>,
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_Gpio1,
+            &gpioInterruptHandler>,
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_Gpio2,
+            &gpioInterruptHandler>,
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_Gpio3,
+            &gpioInterruptHandler>,
+        device::StaticIrqBinding<
+            device::InterruptIds::IrqId_Gpio4,
+            &gpioInterruptHandler>
+    > InterruptMgr;
 
     typedef device::Gpio<InterruptMgr> Gpio;
 
@@ -52,6 +77,7 @@ public:
 
     inline EventLoop& eventLoop();
     inline InterruptMgr& interruptMgr();
+    inline Gpio& gpio();
     inline Uart& uart();
     inline UartSocket& uartSocket();
     inline Led& led();
@@ -92,6 +118,12 @@ inline System::InterruptMgr& System::interruptMgr()
     return interruptMgr_;
 }
 
+inline
+System::Gpio& System::gpio()
+{
+    return gpio_;
+}
+
 inline
 System::Uart& System::uart()
 {
@@ -46,7 +46,9 @@ public:
         device::WaitCond> EventLoop;
 
     // Devices
-    typedef device::InterruptMgr<> InterruptMgr;
+    typedef device::InterruptMgr<
+        embxx::util::StaticFunction<void ()>,
+        true> InterruptMgr;
     typedef device::Gpio<InterruptMgr> Gpio;
     typedef device::Uart1<InterruptMgr> Uart;
     typedef device::Timer<InterruptMgr> TimerDevice;
@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <chrono>
+#include <type_traits>
 
 #include "embxx/util/Assert.h"
 
@@ -54,6 +55,28 @@ private:
 };
 
 namespace log = embxx::util::log;
+
+template <typename TLog, typename TInterruptMgr>
+void logIrqStats(
+    TLog& log,
+    const TInterruptMgr& interruptMgr,
+    typename TInterruptMgr::IrqId id,
+    const char* name)
+{
+    auto stats = interruptMgr.getStats(id);
+    if (stats.count_ == 0) {
+        return;
+    }
+
+    SLOG(log, log::Info,
+        "IRQ " << name << ": count = " << embxx::io::dec << stats.count_ <<
+        "; min = " << stats.minTicks_ <<
+        "; avg = " << TInterruptMgr::getAverageTicks(stats) <<
+        "; max = " << stats.maxTicks_ <<
+        "; p99 = " << TInterruptMgr::getPercentileTicks(stats, 99) <<
+        " (ticks of " << TInterruptMgr::getTicksFrequency() << "Hz)");
+}
+
 template <typename TLog, typename TTimer>
 void performLog(TLog& log, TTimer& timer, std::size_t& counter)
 {
@@ -64,6 +87,15 @@ void performLog(TLog& log, TTimer& timer, std::size_t& counter)
         embxx::io::dec << counter <<
         " (0x" << embxx::io::hex << counter << ")");
 
+    auto& interruptMgr = System::instance().interruptMgr();
+    logIrqStats(log, interruptMgr, System::InterruptMgr::IrqId_Timer, "Timer");
+    logIrqStats(log, interruptMgr, System::InterruptMgr::IrqId_AuxInt, "Aux");
+
+    SLOG(log, log::Info,
+        "CPU utilisation = " << embxx::io::dec <<
+        device::Idle::getUtilisation() << "%");
+    device::Idle::reset();
+
     // Perform next logging after a timeout
     static const auto LoggingWaitPeriod = std::chrono::seconds(1);
     timer.asyncWait(
@@ -76,12 +108,22 @@ void performLog(TLog& log, TTimer& timer, std::size_t& counter)
         });
 }
 
+const char BannerPrefix[] = "\r\nLogging application, built on ";
+const char BannerSep[] = " ";
+const char BannerDate[] = __DATE__;
+const char BannerTime[] = __TIME__;
+
+template <std::size_t TSize>
+System::Uart::WriteSegment makeSegment(const char (&str)[TSize])
+{
+    return System::Uart::WriteSegment{&str[0], TSize - 1};
+}
+
 }  // namespace
 
 int main() {
     auto& system = System::instance();
     auto& led = system.led();
-    auto& log = system.log();
 
     // Led on on assertion failure.
     embxx::util::EnableAssert<LedOnAssert> assertion(std::ref(led));
@@ -95,9 +137,28 @@ int main() {
     auto timer = system.timerMgr().allocTimer();
     GASSERT(timer.isValid());
 
-    // Start logging
+    // Write the banner straight from the static strings, the device
+    // serialises it with the log output written via the driver
+    uart.setGatherWriteCompleteHandler(
+        [](const embxx::error::ErrorStatus& es)
+        {
+            GASSERT(!es);
+            static_cast<void>(es);
+        });
+
+    const System::Uart::WriteSegment banner[] = {
+        makeSegment(BannerPrefix),
+        makeSegment(BannerDate),
+        makeSegment(BannerSep),
+        makeSegment(BannerTime)
+    };
+    uart.startGatherWrite(
+        &banner[0],
+        std::extent<decltype(banner)>::value,
+        System::Uart::EventLoopContext());
+
     std::size_t counter = 0;
-    performLog(log, timer, counter);
+    performLog(system.log(), timer, counter);
 
     // Run event loop
     device::interrupt::enable();
@@ -22,6 +22,7 @@
 .extern __init_array_end
 .extern main
 .extern interruptHandler
+.weak fastInterruptHandler
 
 	.section .init
 	.globl _entry
@@ -45,7 +46,7 @@ prefetch_handler_ptr:   .word hang
 data_handler_ptr:       .word hang
 unused_handler_ptr:     .word hang
 irq_handler_ptr:        .word irq_handler
-fiq_handler_ptr:        .word hang
+fiq_handler_ptr:        .word fiq_handler
 
 reset:
     ;@ Disable interrupts
@@ -113,8 +114,49 @@ hang:
 	b hang
 
 irq_handler:
-    push {r0,r1,r2,r3,r4,r5,r6,r7,r8,r9,r10,r11,r12,lr}
+    ;@ Save return address and state on the supervisor stack and handle
+    ;@ the interrupt in supervisor mode. It allows the handler to re-enable
+    ;@ interrupts (nesting) without corrupting the banked lr_irq.
+    sub lr,lr,#4
+    srsdb sp!,#0x13
+    cps #0x13
+    push {r0,r1,r2,r3,r12,lr}
+
+    ;@ Align stack to 8 bytes as required by AAPCS
+    and r1,sp,#4
+    sub sp,sp,r1
+    push {r1,r2}
+
     bl interruptHandler
-    pop  {r0,r1,r2,r3,r4,r5,r6,r7,r8,r9,r10,r11,r12,lr}
+
+    pop {r1,r2}
+    add sp,sp,r1
+
+    ;@ Clear the exclusive monitor (dummy strex), the LDREX of the
+    ;@ interrupted code must not be paired with its STREX
+    ldr r0,=exclusive_scratch
+    strex r1,r0,[r0]
+
+    pop {r0,r1,r2,r3,r12,lr}
+    rfeia sp!
+
+fiq_handler:
+    ;@ r8-r12 are banked, only r0-r3 and lr need to be preserved,
+    ;@ r12 is pushed to keep the stack 8 bytes aligned.
+    push {r0,r1,r2,r3,r12,lr}
+    bl fastInterruptHandler
+    ldr r0,=exclusive_scratch
+    strex r1,r0,[r0] ;@ Clear the exclusive monitor
+    pop {r0,r1,r2,r3,r12,lr}
     subs pc,lr,#4
 
+;@ Default FIQ handler if application doesn't define one
+fastInterruptHandler:
+    bx lr
+
+    .section .bss
+    .align 2
+
+;@ Target of the dummy strex used to clear the exclusive monitor
+exclusive_scratch:
+    .word 0
@@ -18,9 +18,12 @@
 
 #pragma once
 
+#include <cstdint>
+#include <cstddef>
 #include <functional>
 #include <utility>
 #include <type_traits>
+#include <array>
 
 #include "embxx/util/StaticFunction.h"
 #include "embxx/util/Assert.h"
@@ -45,28 +48,101 @@ public:
 
     explicit Eeprom(Driver& driver);
 
+    /// @brief Set limit of attempts to perform an operation the device
+    ///        does not acknowledge, 0 (default) means unlimited.
     void setAttemptsLimit(AttemtsCountType limit);
 
+    /// @brief Set limit of write cycle completion polls, 0 (default) means
+    ///        unlimited.
+    /// @details After every write the device is busy with its internal
+    ///          write cycle (tWR) and doesn't acknowledge its address. The
+    ///          completion of the write is reported only when the device
+    ///          acknowledges the probe transaction, so the next operation
+    ///          doesn't need to be repeated. The probe is address only
+    ///          write of the address following the written data, i.e. the
+    ///          following current address read continues from there. If the limit is reached, the
+    ///          write is reported as failed with HwProtocolError.
+    void setWriteCyclePollsLimit(AttemtsCountType limit);
+
+    /// @brief Set size of the device write page, used by address based
+    ///        asyncWrite().
+    void setPageSize(std::size_t size);
+
+    std::size_t getPageSize() const;
+
     DeviceIdType getDeviceId() const;
 
     template <typename TFunc>
     void asyncRead(CharType* buf, std::size_t size, TFunc&& callback);
 
+    /// @brief Random read starting from the specified address.
+    /// @details The address is written and the data is read within single
+    ///          I2C transaction using repeated start (see
+    ///          I2C0::setWriteBeforeRead()), i.e. single round trip through
+    ///          the driver instead of separate address write followed by
+    ///          the read.
+    template <typename TFunc>
+    void asyncRead(
+        EepromAddressType address,
+        CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Write the data.
+    /// @details The data starts with the big endian address
+    ///          (sizeof(EepromAddressType) bytes). The callback is invoked
+    ///          when the device completes its internal write cycle, see
+    ///          setWriteCyclePollsLimit(). The address only write (used to
+    ///          set the address of the following current address read)
+    ///          doesn't start the write cycle and completes without
+    ///          polling.
     template <typename TFunc>
     void asyncWrite(const CharType* buf, std::size_t size, TFunc&& callback);
 
+    /// @brief Write the data starting from the specified address.
+    /// @details The data is split on the device page boundaries, the pages
+    ///          are written back to back, every one after the write cycle
+    ///          of the previous one is complete. The address header is
+    ///          attached to every page write (see I2C0::setWriteHeader()),
+    ///          the data is not copied. The callback is invoked once,
+    ///          when the whole data is written or upon the first error,
+    ///          with the number of bytes successfully written.
+    template <typename TFunc>
+    void asyncWrite(
+        EepromAddressType address,
+        const CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    static const std::size_t DefaultPageSize = 32;
+
 private:
     void startOp();
     void opCompleteCallback(const embxx::error::ErrorStatus& err, std::size_t bytesTransferred);
+    void pollWriteCycle();
+    void pollCompleteCallback(const embxx::error::ErrorStatus& err, std::size_t bytesTransferred);
+    void writePage();
+    void setAddressBuf(EepromAddressType address);
     void invokeHandler(const embxx::error::ErrorStatus& err, std::size_t bytesTransferred);
+    typename Driver::Device::Device::Device& bus();
 
     typedef embxx::util::StaticFunction<void ()> DriverCallerFunc;
+    typedef std::array<CharType, sizeof(EepromAddressType)> AddressBuf;
 
     Driver& driver_;
     DriverCallerFunc driverCaller_;
     Handler handler_;
     AttemtsCountType attemptsLimit_;
     AttemtsCountType attempt_;
+    AttemtsCountType pollsLimit_;
+    AttemtsCountType poll_;
+    std::size_t bytesWritten_;
+    std::size_t pageSize_;
+    EepromAddressType pageAddress_;
+    const CharType* pageBuf_;
+    std::size_t pageRemaining_;
+    bool writeOp_;
+    AddressBuf addressBuf_;
 };
 
 // Implementation
@@ -75,7 +151,15 @@ template <typename TDriver, typename THandler>
 Eeprom<TDriver, THandler>::Eeprom(Driver& driver)
     : driver_(driver),
       attemptsLimit_(0),
-      attempt_(0)
+      attempt_(0),
+      pollsLimit_(0),
+      poll_(0),
+      bytesWritten_(0),
+      pageSize_(DefaultPageSize),
+      pageAddress_(0),
+      pageBuf_(nullptr),
+      pageRemaining_(0),
+      writeOp_(false)
 {
 }
 
@@ -85,6 +169,25 @@ void Eeprom<TDriver, THandler>::setAttemptsLimit(AttemtsCountType limit)
     attemptsLimit_ = limit;
 }
 
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::setWriteCyclePollsLimit(AttemtsCountType limit)
+{
+    pollsLimit_ = limit;
+}
+
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::setPageSize(std::size_t size)
+{
+    GASSERT(0 < size);
+    pageSize_ = size;
+}
+
+template <typename TDriver, typename THandler>
+std::size_t Eeprom<TDriver, THandler>::getPageSize() const
+{
+    return pageSize_;
+}
+
 template <typename TDriver, typename THandler>
 typename Eeprom<TDriver, THandler>::DeviceIdType
 Eeprom<TDriver, THandler>::getDeviceId() const
@@ -102,10 +205,47 @@ void Eeprom<TDriver, THandler>::asyncRead(
     GASSERT(!handler_);
     GASSERT(!driverCaller_);
     handler_ = std::forward<TFunc>(callback);
+    writeOp_ = false;
+
+    driverCaller_ =
+        [this, buf, size]()
+        {
+            driver_.asyncRead(
+                buf,
+                size,
+                std::bind(
+                    &Eeprom::opCompleteCallback,
+                    this,
+                    std::placeholders::_1,
+                    std::placeholders::_2));
+        };
+
+    startOp();
+}
+
+template <typename TDriver, typename THandler>
+template <typename TFunc>
+void Eeprom<TDriver, THandler>::asyncRead(
+    EepromAddressType address,
+    CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(!handler_);
+    GASSERT(!driverCaller_);
+    handler_ = std::forward<TFunc>(callback);
+    writeOp_ = false;
+    setAddressBuf(address);
 
     driverCaller_ =
         [this, buf, size]()
         {
+            // Consumed by every read attempt
+            bus().setWriteBeforeRead(
+                getDeviceId(),
+                &addressBuf_[0],
+                addressBuf_.size());
+
             driver_.asyncRead(
                 buf,
                 size,
@@ -129,6 +269,17 @@ void Eeprom<TDriver, THandler>::asyncWrite(
     GASSERT(!handler_);
     GASSERT(!driverCaller_);
     handler_ = std::forward<TFunc>(callback);
+    writeOp_ = (sizeof(EepromAddressType) < size);
+    bytesWritten_ = 0;
+    pageRemaining_ = 0;
+    if (writeOp_) {
+        // Address to probe when the write is complete
+        pageAddress_ =
+            static_cast<EepromAddressType>(
+                ((static_cast<EepromAddressType>(buf[0]) << 8) | buf[1]) +
+                (size - sizeof(EepromAddressType)));
+    }
+
     driverCaller_ =
         [this, buf, size]()
         {
@@ -146,6 +297,27 @@ void Eeprom<TDriver, THandler>::asyncWrite(
     startOp();
 }
 
+template <typename TDriver, typename THandler>
+template <typename TFunc>
+void Eeprom<TDriver, THandler>::asyncWrite(
+    EepromAddressType address,
+    const CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(!handler_);
+    GASSERT(!driverCaller_);
+    GASSERT(0 < size);
+    handler_ = std::forward<TFunc>(callback);
+    writeOp_ = true;
+    bytesWritten_ = 0;
+    pageAddress_ = address;
+    pageBuf_ = buf;
+    pageRemaining_ = size;
+    driverCaller_ = std::bind(&Eeprom::writePage, this);
+    startOp();
+}
+
 template <typename TDriver, typename THandler>
 void Eeprom<TDriver, THandler>::startOp()
 {
@@ -173,9 +345,103 @@ void Eeprom<TDriver, THandler>::opCompleteCallback(
         return;
     }
 
+    if ((!err) && writeOp_) {
+        bytesWritten_ += bytesTransferred;
+        if (0 < pageRemaining_) {
+            GASSERT(bytesTransferred <= pageRemaining_);
+            pageAddress_ += static_cast<EepromAddressType>(bytesTransferred);
+            pageBuf_ += bytesTransferred;
+            pageRemaining_ -= bytesTransferred;
+        }
+        poll_ = 0;
+        pollWriteCycle();
+        return;
+    }
+
     invokeHandler(err, bytesTransferred);
 }
 
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::pollWriteCycle()
+{
+    // The device acknowledges its address only when the write cycle is
+    // over. Address only write of the next address is used as a probe, it
+    // doesn't start the write cycle and leaves the address pointer where
+    // the sequential access expects it, while the written data is never
+    // repeated.
+    setAddressBuf(pageAddress_);
+    driver_.asyncWrite(
+        &addressBuf_[0],
+        addressBuf_.size(),
+        std::bind(
+            &Eeprom::pollCompleteCallback,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2));
+}
+
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::pollCompleteCallback(
+    const embxx::error::ErrorStatus& err,
+    std::size_t bytesTransferred)
+{
+    static_cast<void>(bytesTransferred);
+    if (err == embxx::error::ErrorCode::HwProtocolError) {
+        if (0 < pollsLimit_) {
+            ++poll_;
+            if (pollsLimit_ <= poll_) {
+                invokeHandler(err, bytesWritten_);
+                return;
+            }
+        }
+
+        pollWriteCycle();
+        return;
+    }
+
+    if ((!err) && (0 < pageRemaining_)) {
+        startOp();
+        return;
+    }
+
+    invokeHandler(err, bytesWritten_);
+}
+
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::writePage()
+{
+    GASSERT(0 < pageRemaining_);
+    auto pageOffset = static_cast<std::size_t>(pageAddress_ % pageSize_);
+    auto count = pageSize_ - pageOffset;
+    if (pageRemaining_ < count) {
+        count = pageRemaining_;
+    }
+
+    // Re-attached on every attempt, it is consumed by the write
+    setAddressBuf(pageAddress_);
+    bus().setWriteHeader(
+        getDeviceId(),
+        &addressBuf_[0],
+        addressBuf_.size());
+
+    driver_.asyncWrite(
+        pageBuf_,
+        count,
+        std::bind(
+            &Eeprom::opCompleteCallback,
+            this,
+            std::placeholders::_1,
+            std::placeholders::_2));
+}
+
+template <typename TDriver, typename THandler>
+void Eeprom<TDriver, THandler>::setAddressBuf(EepromAddressType address)
+{
+    // Big endian
+    addressBuf_[0] = static_cast<CharType>(address >> 8);
+    addressBuf_[1] = static_cast<CharType>(address);
+}
+
 template <typename TDriver, typename THandler>
 void Eeprom<TDriver, THandler>::invokeHandler(
     const embxx::error::ErrorStatus& err,
@@ -191,6 +457,12 @@ void Eeprom<TDriver, THandler>::invokeHandler(
     handlerCpy(err, bytesTransferred);
 }
 
+template <typename TDriver, typename THandler>
+typename TDriver::Device::Device::Device& Eeprom<TDriver, THandler>::bus()
+{
+    // Driver -> IdDeviceCharAdapter -> DeviceOpQueue -> I2C device
+    return driver_.device().device().device();
+}
 
 }  // namespace component
 
@@ -0,0 +1,713 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "embxx/util/StaticFunction.h"
+#include "embxx/util/Assert.h"
+#include "embxx/error/ErrorStatus.h"
+
+namespace component
+{
+
+/// @brief Write-back page cache in front of Eeprom.
+/// @details Keeps up to TPageCount pages of the device in RAM. The read and
+///          written data is served from the cached pages, the missing ones
+///          are loaded replacing the least recently used ones. The modified
+///          (dirty) part of the page is written to the device only when
+///          the page is replaced or flushed, i.e. multiple small writes
+///          into the same page are coalesced into single page write.
+///          Only one operation (read, write or flush) may be in progress
+///          at a time.
+/// @tparam TEeprom Eeprom component, its address based read/write API is
+///         used.
+/// @tparam TTimerMgr Timer manager, single timer is allocated for timed
+///         flush.
+/// @tparam TPageSize Size of the cached page, expected to be the write page
+///         size of the device.
+/// @tparam TPageCount Number of cached pages.
+/// @tparam THandler Operation completion handler.
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler =
+              embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&, std::size_t)> >
+class EepromCache
+{
+public:
+    typedef TEeprom Eeprom;
+    typedef TTimerMgr TimerMgr;
+    typedef THandler Handler;
+
+    typedef typename Eeprom::CharType CharType;
+    typedef typename Eeprom::EepromAddressType EepromAddressType;
+    typedef std::chrono::milliseconds FlushDelay;
+
+    static const std::size_t PageSize = TPageSize;
+    static const std::size_t PageCount = TPageCount;
+
+    EepromCache(Eeprom& eeprom, TimerMgr& timerMgr);
+
+    /// @brief Set delay of the timed flush.
+    /// @details When the delay expires after the modification of the
+    ///          clean cache, all the dirty pages are written back in
+    ///          background. The background flush gives way to other
+    ///          operations between the page writes. Zero (default) disables
+    ///          the timed flush.
+    void setFlushDelay(FlushDelay delay);
+
+    /// @brief Check whether there are any modified pages not written to
+    ///        the device yet.
+    bool isDirty() const;
+
+    /// @brief Read the data starting from the specified address.
+    /// @return true if all the data was found in cache and copied
+    ///         synchronously, the callback is invoked only when false is
+    ///         returned.
+    template <typename TFunc>
+    bool asyncRead(
+        EepromAddressType address,
+        CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Write the data starting from the specified address.
+    /// @details The data is written into the cached pages, the pages are
+    ///          loaded first if missing.
+    /// @return true if all the pages were in cache and the data was written
+    ///         synchronously, the callback is invoked only when false is
+    ///         returned.
+    template <typename TFunc>
+    bool asyncWrite(
+        EepromAddressType address,
+        const CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Write back all the dirty pages.
+    /// @return true if there is nothing to write back, the callback is
+    ///         invoked only when false is returned.
+    template <typename TFunc>
+    bool asyncFlush(TFunc&& callback);
+
+private:
+    enum class OpType {
+        Idle,
+        Read,
+        Write,
+        Flush
+    };
+
+    struct Page
+    {
+        Page() : base_(0), lastUse_(0), dirtyBegin_(0), dirtyEnd_(0), valid_(false) {}
+
+        bool isDirty() const
+        {
+            return dirtyBegin_ < dirtyEnd_;
+        }
+
+        std::array<CharType, PageSize> data_;
+        EepromAddressType base_;
+        unsigned lastUse_;
+        std::size_t dirtyBegin_;
+        std::size_t dirtyEnd_;
+        bool valid_;
+    };
+
+    typedef typename TimerMgr::Timer Timer;
+
+    static EepromAddressType pageBase(EepromAddressType address);
+    Page* findPage(EepromAddressType base);
+    Page* findDirtyPage();
+    Page& leastRecentlyUsedPage();
+    bool copyCached();
+    void markDirty(Page& page, std::size_t begin, std::size_t end);
+    void processOp();
+    void fillPage(Page& page, EepromAddressType base);
+    void fillComplete(const embxx::error::ErrorStatus& err);
+    void writeBack(Page& page, bool background);
+    void writeBackComplete(const embxx::error::ErrorStatus& err);
+    void completeOp(const embxx::error::ErrorStatus& err);
+    void scheduleFlush();
+    void flushTimerExpired();
+    void continueBackgroundFlush();
+
+    Eeprom& eeprom_;
+    Timer timer_;
+    FlushDelay flushDelay_;
+    std::array<Page, PageCount> pages_;
+    Handler handler_;
+    OpType op_;
+    EepromAddressType opAddress_;
+    CharType* opReadBuf_;
+    const CharType* opWriteBuf_;
+    std::size_t opRemaining_;
+    std::size_t opDone_;
+    Page* busyPage_; // Page being loaded or written back
+    std::size_t writeBackBegin_;
+    std::size_t writeBackEnd_;
+    unsigned useCounter_;
+    bool timerActive_;
+    bool backgroundFlush_;
+    bool backgroundWriteBack_; // Page is written back by background flush
+
+    static_assert(0 < PageSize, "Page size must be positive");
+    static_assert(0 < PageCount, "At least one page must be cached");
+};
+
+// Implementation
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::EepromCache(
+    Eeprom& eeprom,
+    TimerMgr& timerMgr)
+    : eeprom_(eeprom),
+      timer_(timerMgr.allocTimer()),
+      flushDelay_(0),
+      op_(OpType::Idle),
+      opAddress_(0),
+      opReadBuf_(nullptr),
+      opWriteBuf_(nullptr),
+      opRemaining_(0),
+      opDone_(0),
+      busyPage_(nullptr),
+      writeBackBegin_(0),
+      writeBackEnd_(0),
+      useCounter_(0),
+      timerActive_(false),
+      backgroundFlush_(false),
+      backgroundWriteBack_(false)
+{
+    GASSERT(timer_.isValid());
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::setFlushDelay(
+    FlushDelay delay)
+{
+    flushDelay_ = delay;
+    if (timerActive_) {
+        timer_.cancel();
+        timerActive_ = false;
+    }
+
+    if (isDirty()) {
+        scheduleFlush();
+    }
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+bool EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::isDirty() const
+{
+    if ((busyPage_ != nullptr) && (writeBackBegin_ < writeBackEnd_)) {
+        return true;
+    }
+
+    return std::any_of(
+        pages_.begin(), pages_.end(),
+        [](const Page& page) -> bool
+        {
+            return page.isDirty();
+        });
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+template <typename TFunc>
+bool EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::asyncRead(
+    EepromAddressType address,
+    CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(!handler_);
+    op_ = OpType::Read;
+    opAddress_ = address;
+    opReadBuf_ = buf;
+    opWriteBuf_ = nullptr;
+    opRemaining_ = size;
+    opDone_ = 0;
+
+    if (copyCached()) {
+        op_ = OpType::Idle;
+        return true;
+    }
+
+    handler_ = std::forward<TFunc>(callback);
+    if (busyPage_ == nullptr) {
+        processOp();
+    }
+    return false;
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+template <typename TFunc>
+bool EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::asyncWrite(
+    EepromAddressType address,
+    const CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(!handler_);
+    op_ = OpType::Write;
+    opAddress_ = address;
+    opReadBuf_ = nullptr;
+    opWriteBuf_ = buf;
+    opRemaining_ = size;
+    opDone_ = 0;
+
+    if (copyCached()) {
+        op_ = OpType::Idle;
+        return true;
+    }
+
+    handler_ = std::forward<TFunc>(callback);
+    if (busyPage_ == nullptr) {
+        processOp();
+    }
+    return false;
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+template <typename TFunc>
+bool EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::asyncFlush(
+    TFunc&& callback)
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(!handler_);
+    if (!isDirty()) {
+        return true;
+    }
+
+    op_ = OpType::Flush;
+    opRemaining_ = 0;
+    opDone_ = 0;
+    handler_ = std::forward<TFunc>(callback);
+    if (busyPage_ == nullptr) {
+        processOp();
+    }
+    return false;
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+typename EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::EepromAddressType
+EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::pageBase(
+    EepromAddressType address)
+{
+    return static_cast<EepromAddressType>(address - (address % PageSize));
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+typename EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::Page*
+EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::findPage(
+    EepromAddressType base)
+{
+    auto iter = std::find_if(
+        pages_.begin(), pages_.end(),
+        [base](const Page& page) -> bool
+        {
+            return page.valid_ && (page.base_ == base);
+        });
+
+    if (iter == pages_.end()) {
+        return nullptr;
+    }
+    return &(*iter);
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+typename EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::Page*
+EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::findDirtyPage()
+{
+    auto iter = std::find_if(
+        pages_.begin(), pages_.end(),
+        [](const Page& page) -> bool
+        {
+            return page.isDirty();
+        });
+
+    if (iter == pages_.end()) {
+        return nullptr;
+    }
+    return &(*iter);
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+typename EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::Page&
+EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::leastRecentlyUsedPage()
+{
+    auto* lruPage = &pages_[0];
+    for (auto& page : pages_) {
+        if (!page.valid_) {
+            return page;
+        }
+
+        // The difference is correct even after wrap around of the counter
+        if ((useCounter_ - lruPage->lastUse_) < (useCounter_ - page.lastUse_)) {
+            lruPage = &page;
+        }
+    }
+    return *lruPage;
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+bool EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::copyCached()
+{
+    while (0 < opRemaining_) {
+        auto base = pageBase(opAddress_);
+        auto* page = findPage(base);
+        if (page == nullptr) {
+            return false;
+        }
+
+        auto offset = static_cast<std::size_t>(opAddress_ - base);
+        auto count = PageSize - offset;
+        if (opRemaining_ < count) {
+            count = opRemaining_;
+        }
+
+        if (op_ == OpType::Read) {
+            std::copy_n(&page->data_[offset], count, opReadBuf_ + opDone_);
+        }
+        else {
+            GASSERT(op_ == OpType::Write);
+            std::copy_n(opWriteBuf_ + opDone_, count, &page->data_[offset]);
+            markDirty(*page, offset, offset + count);
+        }
+
+        ++useCounter_;
+        page->lastUse_ = useCounter_;
+        opAddress_ += static_cast<EepromAddressType>(count);
+        opDone_ += count;
+        opRemaining_ -= count;
+    }
+    return true;
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::markDirty(
+    Page& page,
+    std::size_t begin,
+    std::size_t end)
+{
+    if (!page.isDirty()) {
+        page.dirtyBegin_ = begin;
+        page.dirtyEnd_ = end;
+    }
+    else {
+        page.dirtyBegin_ = std::min(page.dirtyBegin_, begin);
+        page.dirtyEnd_ = std::max(page.dirtyEnd_, end);
+    }
+
+    scheduleFlush();
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::processOp()
+{
+    GASSERT(busyPage_ == nullptr);
+    if (op_ == OpType::Idle) {
+        continueBackgroundFlush();
+        return;
+    }
+
+    if (op_ == OpType::Flush) {
+        auto* page = findDirtyPage();
+        if (page == nullptr) {
+            completeOp(embxx::error::ErrorCode::Success);
+            return;
+        }
+
+        writeBack(*page, false);
+        return;
+    }
+
+    if (copyCached()) {
+        completeOp(embxx::error::ErrorCode::Success);
+        return;
+    }
+
+    auto& page = leastRecentlyUsedPage();
+    if (page.isDirty()) {
+        writeBack(page, false);
+        return;
+    }
+
+    fillPage(page, pageBase(opAddress_));
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::fillPage(
+    Page& page,
+    EepromAddressType base)
+{
+    GASSERT(!page.isDirty());
+    page.valid_ = false;
+    page.base_ = base;
+    busyPage_ = &page;
+    eeprom_.asyncRead(
+        base,
+        &page.data_[0],
+        page.data_.size(),
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            static_cast<void>(bytesRead);
+            fillComplete(err);
+        });
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::fillComplete(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT(busyPage_ != nullptr);
+    auto* page = busyPage_;
+    busyPage_ = nullptr;
+    if (err) {
+        completeOp(err);
+        return;
+    }
+
+    page->valid_ = true;
+    ++useCounter_;
+    page->lastUse_ = useCounter_;
+    processOp();
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::writeBack(
+    Page& page,
+    bool background)
+{
+    GASSERT(page.isDirty());
+    GASSERT(busyPage_ == nullptr);
+    backgroundWriteBack_ = background;
+
+    // The page is considered clean while being written back, the writes
+    // into it during this time make it dirty again.
+    busyPage_ = &page;
+    writeBackBegin_ = page.dirtyBegin_;
+    writeBackEnd_ = page.dirtyEnd_;
+    page.dirtyBegin_ = 0;
+    page.dirtyEnd_ = 0;
+
+    eeprom_.asyncWrite(
+        static_cast<EepromAddressType>(page.base_ + writeBackBegin_),
+        &page.data_[writeBackBegin_],
+        writeBackEnd_ - writeBackBegin_,
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesWritten)
+        {
+            static_cast<void>(bytesWritten);
+            writeBackComplete(err);
+        });
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::writeBackComplete(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT(busyPage_ != nullptr);
+    auto* page = busyPage_;
+    busyPage_ = nullptr;
+    if (err) {
+        // Keep the data, it will be written back again later
+        markDirty(*page, writeBackBegin_, writeBackEnd_);
+        writeBackBegin_ = 0;
+        writeBackEnd_ = 0;
+        backgroundFlush_ = false;
+        if (!backgroundWriteBack_) {
+            // Eviction or flush performed by the operation itself
+            GASSERT(op_ != OpType::Idle);
+            completeOp(err);
+            return;
+        }
+
+        // Failed background flush is retried by the timer, the operation
+        // started meanwhile (if any) proceeds.
+        processOp();
+        return;
+    }
+
+    writeBackBegin_ = 0;
+    writeBackEnd_ = 0;
+    processOp();
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::completeOp(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT(op_ != OpType::Idle);
+    auto done = opDone_;
+    op_ = OpType::Idle;
+    opRemaining_ = 0;
+
+    GASSERT(handler_);
+    decltype(handler_) handlerCpy(std::move(handler_));
+    handler_ = nullptr;
+    handlerCpy(err, done);
+
+    if ((op_ == OpType::Idle) && (busyPage_ == nullptr)) {
+        continueBackgroundFlush();
+    }
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::scheduleFlush()
+{
+    if ((flushDelay_.count() == 0) || timerActive_) {
+        return;
+    }
+
+    timerActive_ = true;
+    timer_.asyncWait(
+        flushDelay_,
+        [this](const embxx::error::ErrorStatus& err)
+        {
+            if (err) {
+                return;
+            }
+
+            timerActive_ = false;
+            flushTimerExpired();
+        });
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::flushTimerExpired()
+{
+    backgroundFlush_ = true;
+    if ((op_ == OpType::Idle) && (busyPage_ == nullptr)) {
+        continueBackgroundFlush();
+    }
+}
+
+template <typename TEeprom,
+          typename TTimerMgr,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          typename THandler>
+void EepromCache<TEeprom, TTimerMgr, TPageSize, TPageCount, THandler>::continueBackgroundFlush()
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(busyPage_ == nullptr);
+    if (!backgroundFlush_) {
+        return;
+    }
+
+    auto* page = findDirtyPage();
+    if (page == nullptr) {
+        backgroundFlush_ = false;
+        return;
+    }
+
+    writeBack(*page, true);
+}
+
+}  // namespace component
+
+
@@ -0,0 +1,1192 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+#include "embxx/util/StaticFunction.h"
+#include "embxx/util/Assert.h"
+#include "embxx/error/ErrorStatus.h"
+
+namespace component
+{
+
+/// @brief Log structured key/value store on top of Eeprom.
+/// @details The store occupies TPageCount pages starting from the
+///          provided address and uses them as a circular log: every update
+///          of the value is appended to the current (head) page as a new
+///          record, when the head page is full the next page is opened.
+///          It spreads the writes evenly over the pages and turns random
+///          small updates into sequential page writes. The RAM index of
+///          the latest record of every key is built by asyncMount(),
+///          which reads the pages once, sequentially.
+///
+///          The records of the oldest (tail) page, which are still
+///          referenced by the index, are moved to the head by the garbage
+///          collection, after which the page is released. It runs in
+///          background, from the completion callbacks of the Eeprom
+///          operations on the event loop, when less than two pages are
+///          free, giving way to the user operations between the moved
+///          records. One page is kept free for the garbage collection only.
+///
+///          The page starts with the header (magic, sequence number,
+///          checksum), followed by the records (key, value length,
+///          checksum, value). The records are terminated by the end marker
+///          written after the last record. The value of zero length
+///          records the key removal.
+///
+///          Only one user operation may be in progress at a time.
+/// @tparam TEeprom Eeprom component, its address based read/write API is
+///         used.
+/// @tparam TPageSize Size of the log page, expected to be the write page
+///         size of the device (or its divider).
+/// @tparam TPageCount Number of log pages.
+/// @tparam TMaxKeys Maximal number of the keys, during mount the removed
+///         keys also occupy index entries.
+/// @tparam TMaxValueSize Maximal size of the value.
+/// @tparam THandler Operation completion handler.
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler =
+              embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&, std::size_t)> >
+class EepromKvStore
+{
+public:
+    typedef TEeprom Eeprom;
+    typedef THandler Handler;
+
+    typedef typename Eeprom::CharType CharType;
+    typedef typename Eeprom::EepromAddressType EepromAddressType;
+    typedef std::uint8_t KeyType;
+
+    static const std::size_t PageSize = TPageSize;
+    static const std::size_t PageCount = TPageCount;
+    static const std::size_t MaxKeys = TMaxKeys;
+    static const std::size_t MaxValueSize = TMaxValueSize;
+
+    static const KeyType MinKey = 1;
+    static const KeyType MaxKey = 0xfe;
+
+    EepromKvStore(Eeprom& eeprom, EepromAddressType startAddress);
+
+    bool isMounted() const;
+
+    /// @brief Read the log and build the index.
+    /// @details Must be performed before any other operation. The callback
+    ///          receives the number of the keys found. BufferOverflow
+    ///          error is reported if the index capacity is insufficient.
+    template <typename TFunc>
+    void asyncMount(TFunc&& callback);
+
+    /// @brief Get size of the value, 0 if the key doesn't exist.
+    std::size_t getValueSize(KeyType key) const;
+
+    /// @brief Read the value of the key.
+    /// @details The callback receives the size of the value.
+    /// @return false if the key doesn't exist or the value doesn't fit into
+    ///         the buffer, the callback is not invoked in this case.
+    template <typename TFunc>
+    bool asyncRead(
+        KeyType key,
+        CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Update the value of the key.
+    /// @details BufferOverflow error is reported if there is no space left
+    ///          in the log even after garbage collection.
+    /// @return false if the key or value size is invalid or the index is
+    ///         full, the callback is not invoked in this case.
+    template <typename TFunc>
+    bool asyncWrite(
+        KeyType key,
+        const CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Remove the key.
+    /// @return false if the key doesn't exist, the callback is not invoked
+    ///         in this case.
+    template <typename TFunc>
+    bool asyncRemove(KeyType key, TFunc&& callback);
+
+private:
+    enum class OpType {
+        Idle,
+        Mount,
+        Read,
+        Write
+    };
+
+    enum class StepType {
+        None,
+        MountRead,
+        ValueRead,
+        RecordWrite,
+        GcRead,
+        GcWrite
+    };
+
+    typedef std::uint16_t SeqType;
+
+    struct Entry
+    {
+        Entry() : address_(0), seq_(0), length_(0), key_(0) {}
+
+        EepromAddressType address_;
+        SeqType seq_; // Used during mount only
+        std::uint8_t length_;
+        KeyType key_; // 0 for free entry
+    };
+
+    static const CharType PageMagic = 0xe5;
+    static const CharType EndMarker = 0xff;
+    static const std::size_t PageHeaderSize = 4;
+    static const std::size_t RecordHeaderSize = 3;
+    static const std::size_t MinFreePages = 2;
+
+    static bool isNewer(SeqType seq, SeqType otherSeq);
+    static CharType checksum(const CharType* buf, std::size_t size, CharType init);
+    static std::size_t nextPage(std::size_t idx);
+    EepromAddressType pageAddress(std::size_t idx) const;
+    std::size_t pageIndex(EepromAddressType address) const;
+    std::size_t freePages() const;
+    bool hasRoom(std::size_t recordSize, std::size_t reservedPages) const;
+    bool isGcWanted() const;
+    bool isGcProductive(KeyType updatedKey, std::size_t updateBytes) const;
+    Entry* findEntry(KeyType key);
+    const Entry* findEntry(KeyType key) const;
+    Entry* allocEntry(KeyType key);
+    Entry* findLiveEntry(std::size_t pageIdx);
+    bool startOp(OpType op, KeyType key);
+    void process();
+    void readPage();
+    void mountReadComplete(const embxx::error::ErrorStatus& err);
+    void parsePage(std::size_t idx);
+    bool mountRecord(KeyType key, std::size_t length, EepromAddressType address, SeqType seq);
+    void finaliseMount();
+    void startValueRead();
+    void valueReadComplete(const embxx::error::ErrorStatus& err, std::size_t bytesRead);
+    void startGcRead(const Entry& entry);
+    void gcReadComplete(const embxx::error::ErrorStatus& err);
+    void writeRecord(KeyType key, const CharType* buf, std::size_t size, StepType step);
+    void recordWriteComplete(const embxx::error::ErrorStatus& err);
+    void gcFailed(const embxx::error::ErrorStatus& err);
+    void releaseTail();
+    void completeOp(const embxx::error::ErrorStatus& err, std::size_t value);
+
+    typedef std::array<CharType, PageHeaderSize + RecordHeaderSize + MaxValueSize + 1> RecordBuf;
+    typedef std::array<CharType, MaxValueSize> ValueBuf;
+    typedef std::array<CharType, PageSize> PageBuf;
+
+    Eeprom& eeprom_;
+    EepromAddressType startAddress_;
+    std::array<Entry, MaxKeys> index_;
+    Handler handler_;
+    OpType op_;
+    StepType step_;
+    KeyType opKey_;
+    CharType* opReadBuf_;
+    const CharType* opWriteBuf_;
+    std::size_t opSize_;
+    std::size_t headIdx_;
+    std::size_t headOffset_;
+    std::size_t tailIdx_;
+    std::size_t usedPages_;
+    SeqType nextSeq_;
+    bool mounted_;
+
+    // Mount state
+    std::size_t mountPage_;
+    SeqType mountHeadSeq_;
+    SeqType mountTailSeq_;
+    bool mountOverflow_;
+
+    // Record write state
+    KeyType writeKey_;
+    std::size_t writeLength_;
+    bool writeOpensPage_;
+
+    // Garbage collection state
+    EepromAddressType gcAddress_;
+    KeyType gcKey_;
+    std::size_t gcLength_;
+    std::size_t gcReleases_; // Since start of the user operation
+
+    RecordBuf recordBuf_;
+    ValueBuf gcBuf_;
+    PageBuf pageBuf_;
+
+    static_assert(0 < MaxValueSize, "Values must be non-empty");
+    static_assert(MaxValueSize <= 0xff, "Value length must fit into single byte");
+    static_assert((PageHeaderSize + RecordHeaderSize + MaxValueSize) <= PageSize,
+        "Maximal record must fit into the page");
+    static_assert((MinFreePages + 1) < PageCount, "Too few pages");
+    static_assert(MaxKey < EndMarker, "Key can't be equal to end marker");
+};
+
+// Implementation
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::EepromKvStore(
+    Eeprom& eeprom,
+    EepromAddressType startAddress)
+    : eeprom_(eeprom),
+      startAddress_(startAddress),
+      op_(OpType::Idle),
+      step_(StepType::None),
+      opKey_(0),
+      opReadBuf_(nullptr),
+      opWriteBuf_(nullptr),
+      opSize_(0),
+      headIdx_(0),
+      headOffset_(0),
+      tailIdx_(0),
+      usedPages_(0),
+      nextSeq_(0),
+      mounted_(false),
+      mountPage_(0),
+      mountHeadSeq_(0),
+      mountTailSeq_(0),
+      mountOverflow_(false),
+      writeKey_(0),
+      writeLength_(0),
+      writeOpensPage_(false),
+      gcAddress_(0),
+      gcKey_(0),
+      gcLength_(0),
+      gcReleases_(0)
+{
+    GASSERT((startAddress % PageSize) == 0);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::isMounted() const
+{
+    return mounted_;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+template <typename TFunc>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::asyncMount(
+    TFunc&& callback)
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(step_ == StepType::None);
+    GASSERT(!handler_);
+
+    std::fill(index_.begin(), index_.end(), Entry());
+    mounted_ = false;
+    usedPages_ = 0;
+    mountPage_ = 0;
+    mountOverflow_ = false;
+    op_ = OpType::Mount;
+    handler_ = std::forward<TFunc>(callback);
+    readPage();
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+std::size_t EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::getValueSize(
+    KeyType key) const
+{
+    auto* entry = findEntry(key);
+    if (entry == nullptr) {
+        return 0;
+    }
+    return entry->length_;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+template <typename TFunc>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::asyncRead(
+    KeyType key,
+    CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    auto valueSize = getValueSize(key);
+    if ((valueSize == 0) || (size < valueSize)) {
+        return false;
+    }
+
+    if (!startOp(OpType::Read, key)) {
+        return false;
+    }
+
+    opReadBuf_ = buf;
+    opSize_ = valueSize;
+    handler_ = std::forward<TFunc>(callback);
+    if (step_ == StepType::None) {
+        process();
+    }
+    return true;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+template <typename TFunc>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::asyncWrite(
+    KeyType key,
+    const CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    if ((size == 0) || (MaxValueSize < size)) {
+        return false;
+    }
+
+    if ((findEntry(key) == nullptr) && (findEntry(0) == nullptr)) {
+        // No free index entry
+        return false;
+    }
+
+    if (!startOp(OpType::Write, key)) {
+        return false;
+    }
+
+    opWriteBuf_ = buf;
+    opSize_ = size;
+    handler_ = std::forward<TFunc>(callback);
+    if (step_ == StepType::None) {
+        process();
+    }
+    return true;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+template <typename TFunc>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::asyncRemove(
+    KeyType key,
+    TFunc&& callback)
+{
+    if (findEntry(key) == nullptr) {
+        return false;
+    }
+
+    if (!startOp(OpType::Write, key)) {
+        return false;
+    }
+
+    opWriteBuf_ = nullptr;
+    opSize_ = 0;
+    handler_ = std::forward<TFunc>(callback);
+    if (step_ == StepType::None) {
+        process();
+    }
+    return true;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::isNewer(
+    SeqType seq,
+    SeqType otherSeq)
+{
+    return 0 < static_cast<std::int16_t>(static_cast<SeqType>(seq - otherSeq));
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::CharType
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::checksum(
+    const CharType* buf,
+    std::size_t size,
+    CharType init)
+{
+    unsigned sum = init;
+    for (std::size_t idx = 0; idx < size; ++idx) {
+        sum += buf[idx];
+    }
+    return static_cast<CharType>(~sum);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+std::size_t EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::nextPage(
+    std::size_t idx)
+{
+    return (idx + 1) % PageCount;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::EepromAddressType
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::pageAddress(
+    std::size_t idx) const
+{
+    return static_cast<EepromAddressType>(startAddress_ + (idx * PageSize));
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+std::size_t EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::pageIndex(
+    EepromAddressType address) const
+{
+    return static_cast<std::size_t>(address - startAddress_) / PageSize;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+std::size_t EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::freePages() const
+{
+    return PageCount - usedPages_;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::hasRoom(
+    std::size_t recordSize,
+    std::size_t reservedPages) const
+{
+    if ((0 < usedPages_) && ((headOffset_ + recordSize) <= PageSize)) {
+        return true;
+    }
+
+    return reservedPages < freePages();
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::isGcWanted() const
+{
+    return mounted_ &&
+           (1 < usedPages_) &&
+           (freePages() < MinFreePages) &&
+           isGcProductive(0, 0);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::isGcProductive(
+    KeyType updatedKey,
+    std::size_t updateBytes) const
+{
+    // The records don't span pages, in the worst case the space of the
+    // maximal record minus one byte is wasted at the end of every page.
+    // The garbage collection makes progress only if the live records
+    // are guaranteed to fit into the pages left after keeping
+    // MinFreePages free and one being the head. The record of the
+    // updated key is replaced by the update.
+    static const std::size_t UsablePageSize =
+        PageSize - PageHeaderSize - (RecordHeaderSize + MaxValueSize) + 1;
+
+    std::size_t liveBytes = updateBytes;
+    for (auto& entry : index_) {
+        if ((entry.key_ != 0) && (entry.key_ != updatedKey)) {
+            liveBytes += RecordHeaderSize + entry.length_;
+        }
+    }
+
+    return liveBytes <= ((PageCount - MinFreePages - 1) * UsablePageSize);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::Entry*
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::findEntry(
+    KeyType key)
+{
+    auto iter = std::find_if(
+        index_.begin(), index_.end(),
+        [key](const Entry& entry) -> bool
+        {
+            return entry.key_ == key;
+        });
+
+    if (iter == index_.end()) {
+        return nullptr;
+    }
+    return &(*iter);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+const typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::Entry*
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::findEntry(
+    KeyType key) const
+{
+    return const_cast<EepromKvStore*>(this)->findEntry(key);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::Entry*
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::allocEntry(
+    KeyType key)
+{
+    auto* entry = findEntry(key);
+    if (entry != nullptr) {
+        return entry;
+    }
+
+    entry = findEntry(0);
+    if (entry != nullptr) {
+        *entry = Entry();
+        entry->key_ = key;
+    }
+    return entry;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+typename EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::Entry*
+EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::findLiveEntry(
+    std::size_t pageIdx)
+{
+    auto iter = std::find_if(
+        index_.begin(), index_.end(),
+        [this, pageIdx](const Entry& entry) -> bool
+        {
+            return (entry.key_ != 0) && (pageIndex(entry.address_) == pageIdx);
+        });
+
+    if (iter == index_.end()) {
+        return nullptr;
+    }
+    return &(*iter);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::startOp(
+    OpType op,
+    KeyType key)
+{
+    GASSERT(mounted_);
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(!handler_);
+    if ((!mounted_) ||
+        (op_ != OpType::Idle) ||
+        (key < MinKey) ||
+        (MaxKey < key)) {
+        return false;
+    }
+
+    op_ = op;
+    opKey_ = key;
+    gcReleases_ = 0;
+    return true;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::process()
+{
+    GASSERT(step_ == StepType::None);
+    GASSERT(op_ != OpType::Mount);
+    while (true) {
+        if (op_ == OpType::Read) {
+            startValueRead();
+            return;
+        }
+
+        if (op_ == OpType::Write) {
+            if (hasRoom(RecordHeaderSize + opSize_, 1)) {
+                writeRecord(opKey_, opWriteBuf_, opSize_, StepType::RecordWrite);
+                return;
+            }
+
+            // Even if the progress is not guaranteed, try single lap
+            // over the pages.
+            if ((!isGcProductive(opKey_, RecordHeaderSize + opSize_)) &&
+                (PageCount <= gcReleases_)) {
+                break;
+            }
+        }
+        else if (!isGcWanted()) {
+            return;
+        }
+
+        // Garbage collection of the tail page
+        if (usedPages_ <= 1) {
+            break;
+        }
+
+        auto* entry = findLiveEntry(tailIdx_);
+        if (entry == nullptr) {
+            releaseTail();
+            continue;
+        }
+
+        if (!hasRoom(RecordHeaderSize + entry->length_, 0)) {
+            break;
+        }
+
+        startGcRead(*entry);
+        return;
+    }
+
+    // Too much live data
+    if (op_ == OpType::Write) {
+        completeOp(embxx::error::ErrorCode::BufferOverflow, 0);
+    }
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::readPage()
+{
+    step_ = StepType::MountRead;
+    eeprom_.asyncRead(
+        pageAddress(mountPage_),
+        &pageBuf_[0],
+        pageBuf_.size(),
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            static_cast<void>(bytesRead);
+            mountReadComplete(err);
+        });
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::mountReadComplete(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT(step_ == StepType::MountRead);
+    step_ = StepType::None;
+    if (err) {
+        completeOp(err, 0);
+        return;
+    }
+
+    parsePage(mountPage_);
+    ++mountPage_;
+    if (mountPage_ < PageCount) {
+        readPage();
+        return;
+    }
+
+    finaliseMount();
+    if (mountOverflow_) {
+        completeOp(embxx::error::ErrorCode::BufferOverflow, 0);
+        return;
+    }
+
+    mounted_ = true;
+    auto keysCount =
+        static_cast<std::size_t>(std::count_if(
+            index_.begin(), index_.end(),
+            [](const Entry& entry) -> bool
+            {
+                return entry.key_ != 0;
+            }));
+    completeOp(embxx::error::ErrorCode::Success, keysCount);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::parsePage(
+    std::size_t idx)
+{
+    if ((pageBuf_[0] != PageMagic) ||
+        (pageBuf_[PageHeaderSize - 1] != checksum(&pageBuf_[0], PageHeaderSize - 1, 0))) {
+        return;
+    }
+
+    auto seq =
+        static_cast<SeqType>(
+            (static_cast<SeqType>(pageBuf_[1]) << 8) | pageBuf_[2]);
+
+    auto offset = PageHeaderSize;
+    while ((offset + RecordHeaderSize) <= PageSize) {
+        auto key = pageBuf_[offset];
+        if (key == EndMarker) {
+            break;
+        }
+
+        auto length = static_cast<std::size_t>(pageBuf_[offset + 1]);
+        if ((key < MinKey) ||
+            (MaxValueSize < length) ||
+            (PageSize < (offset + RecordHeaderSize + length))) {
+            break;
+        }
+
+        auto* value = &pageBuf_[offset + RecordHeaderSize];
+        if (pageBuf_[offset + 2] != checksum(value, length, static_cast<CharType>(key + length))) {
+            // Interrupted write
+            break;
+        }
+
+        if (!mountRecord(key, length, static_cast<EepromAddressType>(pageAddress(idx) + offset), seq)) {
+            mountOverflow_ = true;
+        }
+        offset += RecordHeaderSize + length;
+    }
+
+    if ((usedPages_ == 0) || isNewer(seq, mountHeadSeq_)) {
+        headIdx_ = idx;
+        headOffset_ = offset;
+        mountHeadSeq_ = seq;
+    }
+
+    if ((usedPages_ == 0) || isNewer(mountTailSeq_, seq)) {
+        tailIdx_ = idx;
+        mountTailSeq_ = seq;
+    }
+
+    // Number of valid pages, finalised by finaliseMount()
+    ++usedPages_;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+bool EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::mountRecord(
+    KeyType key,
+    std::size_t length,
+    EepromAddressType address,
+    SeqType seq)
+{
+    auto* entry = findEntry(key);
+    if (entry == nullptr) {
+        entry = allocEntry(key);
+        if (entry == nullptr) {
+            return false;
+        }
+    }
+    else if (isNewer(entry->seq_, seq)) {
+        // Newer record has already been found
+        return true;
+    }
+
+    // Records of the same page are parsed in order of their writes
+    entry->address_ = address;
+    entry->seq_ = seq;
+    entry->length_ = static_cast<std::uint8_t>(length);
+    return true;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::finaliseMount()
+{
+    // Removed keys
+    for (auto& entry : index_) {
+        if ((entry.key_ != 0) && (entry.length_ == 0)) {
+            entry = Entry();
+        }
+    }
+
+    if (usedPages_ == 0) {
+        // Empty log, the first write opens the first page
+        headIdx_ = PageCount - 1;
+        headOffset_ = PageSize;
+        tailIdx_ = 0;
+        nextSeq_ = 0;
+        return;
+    }
+
+    // The pages are used sequentially, the ones between tail and head
+    // (including stale released ones) belong to the log.
+    usedPages_ = ((headIdx_ + PageCount - tailIdx_) % PageCount) + 1;
+    nextSeq_ = static_cast<SeqType>(mountHeadSeq_ + 1);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::startValueRead()
+{
+    auto* entry = findEntry(opKey_);
+    GASSERT(entry != nullptr);
+    GASSERT(entry->length_ == opSize_);
+    step_ = StepType::ValueRead;
+    eeprom_.asyncRead(
+        static_cast<EepromAddressType>(entry->address_ + RecordHeaderSize),
+        opReadBuf_,
+        entry->length_,
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            valueReadComplete(err, bytesRead);
+        });
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::valueReadComplete(
+    const embxx::error::ErrorStatus& err,
+    std::size_t bytesRead)
+{
+    GASSERT(step_ == StepType::ValueRead);
+    step_ = StepType::None;
+    completeOp(err, bytesRead);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::startGcRead(
+    const Entry& entry)
+{
+    gcAddress_ = entry.address_;
+    gcKey_ = entry.key_;
+    gcLength_ = entry.length_;
+    step_ = StepType::GcRead;
+    eeprom_.asyncRead(
+        static_cast<EepromAddressType>(gcAddress_ + RecordHeaderSize),
+        &gcBuf_[0],
+        gcLength_,
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesRead)
+        {
+            static_cast<void>(bytesRead);
+            gcReadComplete(err);
+        });
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::gcReadComplete(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT(step_ == StepType::GcRead);
+    step_ = StepType::None;
+    if (err) {
+        gcFailed(err);
+        return;
+    }
+
+    // The record is moved without giving way to the user operation, the
+    // space for it has already been checked.
+    writeRecord(gcKey_, &gcBuf_[0], gcLength_, StepType::GcWrite);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::writeRecord(
+    KeyType key,
+    const CharType* buf,
+    std::size_t size,
+    StepType step)
+{
+    GASSERT(size <= MaxValueSize);
+    auto recordSize = RecordHeaderSize + size;
+    writeOpensPage_ = (usedPages_ == 0) || (PageSize < (headOffset_ + recordSize));
+
+    std::size_t pos = 0;
+    std::size_t offset = headOffset_;
+    auto pageIdx = headIdx_;
+    if (writeOpensPage_) {
+        pageIdx = nextPage(headIdx_);
+        offset = PageHeaderSize;
+        recordBuf_[pos++] = PageMagic;
+        recordBuf_[pos++] = static_cast<CharType>(nextSeq_ >> 8);
+        recordBuf_[pos++] = static_cast<CharType>(nextSeq_);
+        recordBuf_[pos] = checksum(&recordBuf_[0], pos, 0);
+        ++pos;
+    }
+
+    recordBuf_[pos++] = key;
+    recordBuf_[pos++] = static_cast<CharType>(size);
+    recordBuf_[pos++] = checksum(buf, size, static_cast<CharType>(key + size));
+    std::copy_n(buf, size, &recordBuf_[pos]);
+    pos += size;
+
+    if ((offset + recordSize) < PageSize) {
+        recordBuf_[pos++] = EndMarker;
+    }
+
+    writeKey_ = key;
+    writeLength_ = size;
+    step_ = step;
+    auto address = static_cast<EepromAddressType>(pageAddress(pageIdx) + offset);
+    if (writeOpensPage_) {
+        address = pageAddress(pageIdx);
+    }
+
+    eeprom_.asyncWrite(
+        address,
+        &recordBuf_[0],
+        pos,
+        [this](const embxx::error::ErrorStatus& err, std::size_t bytesWritten)
+        {
+            static_cast<void>(bytesWritten);
+            recordWriteComplete(err);
+        });
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::recordWriteComplete(
+    const embxx::error::ErrorStatus& err)
+{
+    GASSERT((step_ == StepType::RecordWrite) || (step_ == StepType::GcWrite));
+    auto step = step_;
+    step_ = StepType::None;
+    if (err) {
+        // The partially written record is overwritten by the next one
+        if (step == StepType::RecordWrite) {
+            completeOp(err, 0);
+            return;
+        }
+
+        gcFailed(err);
+        return;
+    }
+
+    if (writeOpensPage_) {
+        headIdx_ = nextPage(headIdx_);
+        headOffset_ = PageHeaderSize;
+        if (usedPages_ == 0) {
+            tailIdx_ = headIdx_;
+        }
+        ++usedPages_;
+        ++nextSeq_;
+    }
+
+    auto address = static_cast<EepromAddressType>(pageAddress(headIdx_) + headOffset_);
+    headOffset_ += RecordHeaderSize + writeLength_;
+
+    if (writeLength_ == 0) {
+        auto* entry = findEntry(writeKey_);
+        if (entry != nullptr) {
+            *entry = Entry();
+        }
+    }
+    else {
+        auto* entry = allocEntry(writeKey_);
+        GASSERT(entry != nullptr);
+        if (entry != nullptr) {
+            entry->address_ = address;
+            entry->length_ = static_cast<std::uint8_t>(writeLength_);
+        }
+    }
+
+    if (step == StepType::RecordWrite) {
+        completeOp(embxx::error::ErrorCode::Success, writeLength_);
+        return;
+    }
+
+    process();
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::gcFailed(
+    const embxx::error::ErrorStatus& err)
+{
+    // The garbage collection is retried after the next user operation,
+    // the pending one proceeds if it doesn't depend on it.
+    if (op_ == OpType::Idle) {
+        return;
+    }
+
+    if ((op_ == OpType::Write) && (!hasRoom(RecordHeaderSize + opSize_, 1))) {
+        completeOp(err, 0);
+        return;
+    }
+
+    if (op_ == OpType::Read) {
+        startValueRead();
+        return;
+    }
+
+    writeRecord(opKey_, opWriteBuf_, opSize_, StepType::RecordWrite);
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::releaseTail()
+{
+    GASSERT(1 < usedPages_);
+    GASSERT(tailIdx_ != headIdx_);
+    // The page content stays intact until it's reused, the released pages
+    // are reused in the same order they were released, so the records
+    // superseded by the removal markers of later pages never reappear.
+    tailIdx_ = nextPage(tailIdx_);
+    --usedPages_;
+    ++gcReleases_;
+}
+
+template <typename TEeprom,
+          std::size_t TPageSize,
+          std::size_t TPageCount,
+          std::size_t TMaxKeys,
+          std::size_t TMaxValueSize,
+          typename THandler>
+void EepromKvStore<TEeprom, TPageSize, TPageCount, TMaxKeys, TMaxValueSize, THandler>::completeOp(
+    const embxx::error::ErrorStatus& err,
+    std::size_t value)
+{
+    GASSERT(op_ != OpType::Idle);
+    op_ = OpType::Idle;
+
+    GASSERT(handler_);
+    decltype(handler_) handlerCpy(std::move(handler_));
+    handler_ = nullptr;
+    handlerCpy(err, value);
+
+    // Background garbage collection
+    if ((op_ == OpType::Idle) && (step_ == StepType::None) && isGcWanted()) {
+        process();
+    }
+}
+
+}  // namespace component
+
+
@@ -0,0 +1,280 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <utility>
+
+#include "embxx/util/StaticFunction.h"
+#include "embxx/util/Assert.h"
+#include "embxx/error/ErrorStatus.h"
+
+namespace component
+{
+
+/// @brief Presents multiple Eeprom devices as single linear address space.
+/// @details The address space is interleaved between the devices with
+///          page granularity: page 0 belongs to the first device, page 1
+///          to the second one, etc... Every device processes its pages of
+///          the request one by one independently of the others, so while
+///          one device is busy with its internal write cycle (see
+///          Eeprom::setWriteCyclePollsLimit()), the pages of the other
+///          devices are transferred. The devices are expected to share the
+///          bus via operation queue with capacity for all of them.
+///          Only one operation may be in progress at a time.
+/// @tparam TEeprom Eeprom component, its address based read/write API is
+///         used. All the devices must have the same page size.
+/// @tparam TCount Number of devices.
+/// @tparam THandler Operation completion handler.
+template <typename TEeprom,
+          std::size_t TCount,
+          typename THandler =
+              embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&, std::size_t)> >
+class EepromStripe
+{
+public:
+    typedef TEeprom Eeprom;
+    typedef THandler Handler;
+
+    typedef typename Eeprom::CharType CharType;
+    typedef std::uint32_t AddressType;
+    typedef std::array<Eeprom*, TCount> Devices;
+
+    static const std::size_t Count = TCount;
+
+    explicit EepromStripe(const Devices& devices);
+
+    /// @brief Get size of the interleaving unit (page size of the devices).
+    std::size_t getStripeSize() const;
+
+    /// @brief Read the data starting from the specified address.
+    /// @details The callback receives the number of bytes read.
+    template <typename TFunc>
+    void asyncRead(
+        AddressType address,
+        CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+    /// @brief Write the data starting from the specified address.
+    /// @details The callback is invoked when all the devices complete their
+    ///          write cycles. In case of error the rest of the pages is not
+    ///          written, the callback receives the number of bytes written.
+    template <typename TFunc>
+    void asyncWrite(
+        AddressType address,
+        const CharType* buf,
+        std::size_t size,
+        TFunc&& callback);
+
+private:
+    typedef typename Eeprom::EepromAddressType EepromAddressType;
+
+    void startOp(AddressType address, std::size_t size);
+    void startStripe(std::size_t deviceIdx);
+    void stripeComplete(
+        std::size_t deviceIdx,
+        const embxx::error::ErrorStatus& err,
+        std::size_t bytesTransferred);
+
+    Devices devices_;
+    std::array<std::size_t, Count> nextStripe_;
+    Handler handler_;
+    CharType* readBuf_;
+    const CharType* writeBuf_;
+    AddressType opAddress_;
+    std::size_t opSize_;
+    std::size_t opDone_;
+    std::size_t activeCount_;
+    std::size_t stripeSize_;
+    embxx::error::ErrorStatus opStatus_;
+
+    static_assert(0 < Count, "At least one device is required");
+};
+
+// Implementation
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+EepromStripe<TEeprom, TCount, THandler>::EepromStripe(const Devices& devices)
+    : devices_(devices),
+      readBuf_(nullptr),
+      writeBuf_(nullptr),
+      opAddress_(0),
+      opSize_(0),
+      opDone_(0),
+      activeCount_(0),
+      stripeSize_(0)
+{
+    for (auto* device : devices_) {
+        static_cast<void>(device);
+        GASSERT(device != nullptr);
+    }
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+std::size_t EepromStripe<TEeprom, TCount, THandler>::getStripeSize() const
+{
+    return devices_[0]->getPageSize();
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+template <typename TFunc>
+void EepromStripe<TEeprom, TCount, THandler>::asyncRead(
+    AddressType address,
+    CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(!handler_);
+    handler_ = std::forward<TFunc>(callback);
+    readBuf_ = buf;
+    writeBuf_ = nullptr;
+    startOp(address, size);
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+template <typename TFunc>
+void EepromStripe<TEeprom, TCount, THandler>::asyncWrite(
+    AddressType address,
+    const CharType* buf,
+    std::size_t size,
+    TFunc&& callback)
+{
+    GASSERT(!handler_);
+    handler_ = std::forward<TFunc>(callback);
+    readBuf_ = nullptr;
+    writeBuf_ = buf;
+    startOp(address, size);
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+void EepromStripe<TEeprom, TCount, THandler>::startOp(
+    AddressType address,
+    std::size_t size)
+{
+    GASSERT(0 < size);
+    GASSERT(activeCount_ == 0);
+
+    // The page size may be updated after construction, take a snapshot
+    // for the duration of the operation.
+    stripeSize_ = getStripeSize();
+    for (auto* device : devices_) {
+        static_cast<void>(device);
+        GASSERT(device->getPageSize() == stripeSize_);
+    }
+
+    opAddress_ = address;
+    opSize_ = size;
+    opDone_ = 0;
+    opStatus_ = embxx::error::ErrorCode::Success;
+
+    // First stripe of every device within the request
+    auto firstStripe = static_cast<std::size_t>(address / stripeSize_);
+    auto lastStripe = static_cast<std::size_t>((address + size - 1) / stripeSize_);
+    for (std::size_t idx = 0; idx < Count; ++idx) {
+        auto stripe = firstStripe + ((idx + Count - (firstStripe % Count)) % Count);
+        nextStripe_[idx] = stripe;
+        if (stripe <= lastStripe) {
+            ++activeCount_;
+        }
+    }
+
+    // The counter is complete before any of the devices is started
+    for (std::size_t idx = 0; idx < Count; ++idx) {
+        if (nextStripe_[idx] <= lastStripe) {
+            startStripe(idx);
+        }
+    }
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+void EepromStripe<TEeprom, TCount, THandler>::startStripe(
+    std::size_t deviceIdx)
+{
+    auto stripe = nextStripe_[deviceIdx];
+    auto stripeStart = static_cast<AddressType>(stripe * stripeSize_);
+    auto start = stripeStart;
+    if (start < opAddress_) {
+        start = opAddress_;
+    }
+
+    auto end = static_cast<AddressType>(stripeStart + stripeSize_);
+    auto opEnd = static_cast<AddressType>(opAddress_ + opSize_);
+    if (opEnd < end) {
+        end = opEnd;
+    }
+
+    GASSERT(start < end);
+    auto deviceAddress =
+        static_cast<EepromAddressType>(
+            ((stripe / Count) * stripeSize_) + (start - stripeStart));
+    auto bufOffset = static_cast<std::size_t>(start - opAddress_);
+    auto length = static_cast<std::size_t>(end - start);
+
+    auto& device = *devices_[deviceIdx];
+    auto completeFunc =
+        [this, deviceIdx](const embxx::error::ErrorStatus& err, std::size_t bytesTransferred)
+        {
+            stripeComplete(deviceIdx, err, bytesTransferred);
+        };
+
+    if (readBuf_ != nullptr) {
+        device.asyncRead(deviceAddress, readBuf_ + bufOffset, length, completeFunc);
+        return;
+    }
+
+    GASSERT(writeBuf_ != nullptr);
+    device.asyncWrite(deviceAddress, writeBuf_ + bufOffset, length, completeFunc);
+}
+
+template <typename TEeprom, std::size_t TCount, typename THandler>
+void EepromStripe<TEeprom, TCount, THandler>::stripeComplete(
+    std::size_t deviceIdx,
+    const embxx::error::ErrorStatus& err,
+    std::size_t bytesTransferred)
+{
+    GASSERT(0 < activeCount_);
+    opDone_ += bytesTransferred;
+    if (err && (!opStatus_)) {
+        opStatus_ = err;
+    }
+
+    auto lastStripe =
+        static_cast<std::size_t>((opAddress_ + opSize_ - 1) / stripeSize_);
+    nextStripe_[deviceIdx] += Count;
+    if ((!opStatus_) && (nextStripe_[deviceIdx] <= lastStripe)) {
+        startStripe(deviceIdx);
+        return;
+    }
+
+    --activeCount_;
+    if (0 < activeCount_) {
+        return;
+    }
+
+    GASSERT(handler_);
+    decltype(handler_) handlerCpy(std::move(handler_));
+    handler_ = nullptr;
+    handlerCpy(opStatus_, opDone_);
+}
+
+}  // namespace component
+
+
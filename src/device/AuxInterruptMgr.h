@@ -0,0 +1,129 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <functional>
+
+#include "embxx/util/Assert.h"
+#include "embxx/util/StaticFunction.h"
+
+namespace device
+{
+
+/// @brief Demultiplexer of the interrupt shared by the auxiliary
+///        peripherals (mini UART, SPI1 and SPI2).
+/// @details Registers itself as the handler of the AUX interrupt source
+///          and invokes the handlers of the peripherals that have their
+///          interrupt pending according to AUX_IRQ register. The source is
+///          enabled in the interrupt controller for the whole lifetime of
+///          the object, the peripherals gate their interrupts using their
+///          own enable bits. When used together with Uart1, the
+///          demultiplexer must be passed to the constructor of the latter
+///          (see Uart1::AuxInterruptMgr), which registers its handler as
+///          IrqId_MiniUart. Routing of the AUX interrupt to FIQ applies
+///          to all the auxiliary peripherals.
+/// @tparam TInterruptMgr Interrupt manager.
+/// @tparam THandler Type of the interrupt handler functor.
+template <typename TInterruptMgr,
+          typename THandler = embxx::util::StaticFunction<void ()> >
+class AuxInterruptMgr
+{
+public:
+    typedef TInterruptMgr InterruptMgr;
+    typedef THandler HandlerFunc;
+
+    enum IrqId {
+        IrqId_MiniUart,
+        IrqId_Spi1,
+        IrqId_Spi2,
+        IrqId_NumOfIds // Must be last
+    };
+
+    AuxInterruptMgr(InterruptMgr& interruptMgr);
+
+    ~AuxInterruptMgr();
+
+    template <typename TFunc>
+    void registerHandler(IrqId id, TFunc&& handler);
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void handleInterrupt();
+
+private:
+    typedef std::uint32_t EntryType;
+    typedef typename InterruptMgr::IrqId ParentIrqId;
+
+    InterruptMgr& interruptMgr_;
+    std::array<HandlerFunc, IrqId_NumOfIds> handlers_;
+
+    static constexpr auto pAUX_IRQ =
+        reinterpret_cast<volatile EntryType*>(0x20215000);
+};
+
+// Implementation
+template <typename TInterruptMgr, typename THandler>
+AuxInterruptMgr<TInterruptMgr, THandler>::AuxInterruptMgr(
+    InterruptMgr& interruptMgr)
+    : interruptMgr_(interruptMgr)
+{
+    interruptMgr_.registerHandler(
+        ParentIrqId::IrqId_AuxInt,
+        std::bind(&AuxInterruptMgr::handleInterrupt, this));
+    interruptMgr_.enableInterrupt(ParentIrqId::IrqId_AuxInt);
+}
+
+template <typename TInterruptMgr, typename THandler>
+AuxInterruptMgr<TInterruptMgr, THandler>::~AuxInterruptMgr()
+{
+    interruptMgr_.disableInterrupt(ParentIrqId::IrqId_AuxInt);
+}
+
+template <typename TInterruptMgr, typename THandler>
+template <typename TFunc>
+void AuxInterruptMgr<TInterruptMgr, THandler>::registerHandler(
+    IrqId id,
+    TFunc&& handler)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    handlers_[id] = std::forward<TFunc>(handler);
+}
+
+template <typename TInterruptMgr, typename THandler>
+void AuxInterruptMgr<TInterruptMgr, THandler>::handleInterrupt()
+{
+    // Bit per peripheral in the order of IrqId values
+    auto pending = *pAUX_IRQ;
+    for (auto id = 0U; id < IrqId_NumOfIds; ++id) {
+        if ((pending & (static_cast<EntryType>(1) << id)) == 0) {
+            continue;
+        }
+
+        auto& handler = handlers_[id];
+        GASSERT(handler);
+        if (handler) {
+            handler();
+        }
+    }
+}
+
+}  // namespace device
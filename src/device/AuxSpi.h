@@ -0,0 +1,979 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <algorithm>
+#include <functional>
+
+#include "embxx/util/Assert.h"
+#include "embxx/util/StaticFunction.h"
+#include "embxx/error/ErrorStatus.h"
+#include "embxx/device/context.h"
+
+#include "Function.h"
+
+namespace device
+{
+
+/// @brief Auxiliary SPI (SPI1/SPI2) master device.
+/// @details Implements the same read/write interface as Spi0 to be used
+///          with embxx::device::IdDeviceCharAdapter, several instances
+///          allow independent concurrent transfers on separate buses.
+///          Uses variable width shift mode, up to 3 characters are
+///          packed into every FIFO entry. The chip select is held active
+///          between FIFO refills as long as there are characters left to
+///          transfer. The chip select 2 of SPI1 (GPIO16) drives the
+///          on-board led and is not supported.
+/// @tparam TInterruptMgr Demultiplexer of the AUX interrupt (see
+///         AuxInterruptMgr).
+/// @tparam TCanDoHandler Type of the "can read"/"can write" callbacks.
+/// @tparam TOpCompleteHandler Type of the operation completion callbacks.
+template <typename TInterruptMgr,
+          typename TCanDoHandler = embxx::util::StaticFunction<void ()>,
+          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)> >
+class AuxSpi
+{
+public:
+
+    typedef std::uint8_t CharType;
+    typedef unsigned DeviceIdType;
+
+    static const DeviceIdType SupportedDeviceIdsCount = 2U;
+
+    typedef TInterruptMgr InterruptMgr;
+    typedef TCanDoHandler CanReadHandler;
+    typedef TCanDoHandler CanWriteHandler;
+    typedef TOpCompleteHandler ReadCompleteHandler;
+    typedef TOpCompleteHandler WriteCompleteHandler;
+    typedef std::uint32_t EntryType;
+
+    typedef embxx::device::context::EventLoop EventLoopContext;
+    typedef embxx::device::context::Interrupt InterruptContext;
+
+    enum Bus
+    {
+        Bus_Spi1,
+        Bus_Spi2,
+        NumOfBuses
+    };
+
+    enum Mode
+    {
+        Mode0,
+        Mode1,
+        Mode2,
+        Mode3,
+        NumOfModes
+    };
+
+    AuxSpi(
+        InterruptMgr& interruptMgr,
+        Function& funcDev,
+        Bus bus,
+        Mode mode = Mode0);
+
+    ~AuxSpi();
+
+    unsigned getFreq(unsigned sysFreq) const;
+    void setFreq(unsigned sysFreq, unsigned busFreq);
+
+    Mode getMode() const;
+    void setMode(Mode mode);
+
+    CharType getFillChar() const;
+    void setFillChar(CharType ch);
+
+    template <typename TFunc>
+    void setCanReadHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setCanWriteHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setReadCompleteHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setWriteCompleteHandler(TFunc&& func);
+
+    void startRead(
+        DeviceIdType id,
+        std::size_t length,
+        EventLoopContext context);
+
+    void startRead(
+        DeviceIdType id,
+        std::size_t length,
+        InterruptContext context);
+
+    bool cancelRead(EventLoopContext context);
+    bool cancelRead(InterruptContext context);
+
+    void startWrite(
+        DeviceIdType id,
+        std::size_t length,
+        EventLoopContext context);
+
+    void startWrite(
+        DeviceIdType id,
+        std::size_t length,
+        InterruptContext context);
+
+    bool cancelWrite(EventLoopContext context);
+    bool cancelWrite(InterruptContext context);
+
+    bool suspend(EventLoopContext context);
+    void resume(EventLoopContext context);
+
+    bool canRead(InterruptContext context);
+    bool canWrite(InterruptContext context);
+    CharType read(InterruptContext context);
+    void write(CharType value, InterruptContext context);
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the AUX interrupt demultiplexer by the
+    ///          constructor, public to allow static binding.
+    void interruptHandler();
+
+private:
+    typedef typename InterruptMgr::IrqId IrqId;
+    typedef Function::PinIdxType PinIdxType;
+    typedef Function::FuncSel FuncSel;
+
+    static const std::size_t FifoDepth = 4U;
+    static const std::size_t MaxCharsPerEntry = 3U;
+    static const std::size_t MaxChunkLen = FifoDepth * MaxCharsPerEntry;
+
+    volatile EntryType* reg(std::size_t offset) const;
+    void selectChip(DeviceIdType id);
+    DeviceIdType getChip() const;
+    void startReadInternal(DeviceIdType id, std::size_t length);
+    void startWriteInternal(DeviceIdType id, std::size_t length);
+    bool cancelReadInternal();
+    bool cancelWriteInternal();
+    void disableInterrupts();
+    void enableInterrupts();
+    void beginTransfer(DeviceIdType id);
+    void stopTransfer();
+    void receiveChunk();
+    void transmitChunk();
+    void reportReadComplete(const embxx::error::ErrorStatus& es);
+    void reportWriteComplete(const embxx::error::ErrorStatus& es);
+    bool readOpInProgress() const;
+    bool writeOpInProgress() const;
+
+    InterruptMgr& interruptMgr_;
+    Bus bus_;
+    CanReadHandler canReadHandler_;
+    CanWriteHandler canWriteHandler_;
+    ReadCompleteHandler readCompleteHandler_;
+    WriteCompleteHandler writeCompleteHandler_;
+    std::size_t remainingReadLen_;
+    std::size_t remainingWriteLen_;
+    std::size_t readFifoSize_;
+    std::size_t writeFifoSize_;
+    EntryType cntl0Cache_;
+    CharType fillChar_;
+    bool transferActive_;
+    bool interruptsEnabled_;
+    bool csHeld_;
+
+    // Characters of the chunk being transmitted/received
+    std::array<CharType, MaxChunkLen> chunk_;
+    std::size_t chunkIdx_;
+    std::size_t chunkReadLen_;
+    std::array<std::size_t, FifoDepth> entryLens_;
+    std::size_t entriesCount_;
+
+    static const FuncSel AltFuncAll = FuncSel::Alt4;
+
+    static const PinIdxType LineSpi1CE1 = 17;
+    static const PinIdxType LineSpi1CE0 = 18;
+    static const PinIdxType LineSpi1MISO = 19;
+    static const PinIdxType LineSpi1MOSI = 20;
+    static const PinIdxType LineSpi1SCLK = 21;
+
+    static const PinIdxType LineSpi2MISO = 40;
+    static const PinIdxType LineSpi2MOSI = 41;
+    static const PinIdxType LineSpi2SCLK = 42;
+    static const PinIdxType LineSpi2CE0 = 43;
+    static const PinIdxType LineSpi2CE1 = 44;
+
+    static constexpr EntryType genMask(std::size_t pos, std::size_t len = 1)
+    {
+        return ((static_cast<EntryType>(1) << len) - 1) << pos;
+    }
+
+    static constexpr auto pAUX_ENABLES =
+        reinterpret_cast<volatile EntryType*>(0x20215004);
+    static const std::size_t Spi1EnablePos = 1;
+
+    static const EntryType Spi1Base = 0x20215080;
+    static const EntryType Spi2Base = 0x202150C0;
+
+    static const std::size_t CNTL0_Offset = 0x00;
+    static const std::size_t CNTL0_MSBF_OUT_Pos = 6;
+    static const std::size_t CNTL0_CPOL_Pos = 7;
+    static const std::size_t CNTL0_OUT_RISING_Pos = 8;
+    static const std::size_t CNTL0_CLEARFIFO_Pos = 9;
+    static const std::size_t CNTL0_IN_RISING_Pos = 10;
+    static const std::size_t CNTL0_ENABLE_Pos = 11;
+    static const std::size_t CNTL0_VAR_WIDTH_Pos = 14;
+    static const std::size_t CNTL0_CS_Pos = 17;
+    static const std::size_t CNTL0_CS_Len = 3;
+    static const std::size_t CNTL0_SPEED_Pos = 20;
+    static const std::size_t CNTL0_SPEED_Len = 12;
+
+    static const EntryType CNTL0_ModeMask =
+        genMask(CNTL0_CPOL_Pos) |
+        genMask(CNTL0_OUT_RISING_Pos) |
+        genMask(CNTL0_IN_RISING_Pos);
+
+    static const std::size_t CNTL1_Offset = 0x04;
+    static const std::size_t CNTL1_MSBF_IN_Pos = 1;
+    static const std::size_t CNTL1_IDLE_IRQ_Pos = 6;
+
+    static const std::size_t STAT_Offset = 0x08;
+    static const std::size_t STAT_BUSY_Pos = 6;
+    static const std::size_t STAT_RX_EMPTY_Pos = 7;
+    static const std::size_t STAT_TX_EMPTY_Pos = 9;
+
+    // Writes to IO release the chip select when the shift is over,
+    // writes to TXHOLD keep it active.
+    static const std::size_t IO_Offset = 0x20;
+    static const std::size_t TXHOLD_Offset = 0x30;
+    static const std::size_t VarWidthPos = 24;
+};
+
+// Implementation
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::AuxSpi(
+    InterruptMgr& interruptMgr,
+    Function& funcDev,
+    Bus bus,
+    Mode mode)
+    : interruptMgr_(interruptMgr),
+      bus_(bus),
+      remainingReadLen_(0),
+      remainingWriteLen_(0),
+      readFifoSize_(0),
+      writeFifoSize_(0),
+      cntl0Cache_(
+          genMask(CNTL0_MSBF_OUT_Pos) |
+          genMask(CNTL0_ENABLE_Pos) |
+          genMask(CNTL0_VAR_WIDTH_Pos) |
+          genMask(CNTL0_CS_Pos, CNTL0_CS_Len)),
+      fillChar_(0),
+      transferActive_(false),
+      interruptsEnabled_(true),
+      csHeld_(false),
+      chunkIdx_(0),
+      chunkReadLen_(0),
+      entriesCount_(0)
+{
+    GASSERT(bus_ < NumOfBuses);
+    if (bus_ == Bus_Spi1) {
+        funcDev.configure(LineSpi1CE0, AltFuncAll);
+        funcDev.configure(LineSpi1CE1, AltFuncAll);
+        funcDev.configure(LineSpi1MISO, AltFuncAll);
+        funcDev.configure(LineSpi1MOSI, AltFuncAll);
+        funcDev.configure(LineSpi1SCLK, AltFuncAll);
+    }
+    else {
+        funcDev.configure(LineSpi2CE0, AltFuncAll);
+        funcDev.configure(LineSpi2CE1, AltFuncAll);
+        funcDev.configure(LineSpi2MISO, AltFuncAll);
+        funcDev.configure(LineSpi2MOSI, AltFuncAll);
+        funcDev.configure(LineSpi2SCLK, AltFuncAll);
+    }
+
+    *pAUX_ENABLES |= genMask(Spi1EnablePos + bus_);
+
+    setMode(mode);
+    *reg(CNTL0_Offset) = cntl0Cache_ | genMask(CNTL0_CLEARFIFO_Pos);
+    *reg(CNTL0_Offset) = cntl0Cache_;
+    *reg(CNTL1_Offset) = genMask(CNTL1_MSBF_IN_Pos);
+
+    auto irqId = IrqId::IrqId_Spi1;
+    if (bus_ == Bus_Spi2) {
+        irqId = IrqId::IrqId_Spi2;
+    }
+
+    interruptMgr_.registerHandler(
+        irqId,
+        std::bind(&AuxSpi::interruptHandler, this));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::~AuxSpi()
+{
+    *reg(CNTL1_Offset) = 0;
+    *reg(CNTL0_Offset) = 0;
+    *pAUX_ENABLES &= ~genMask(Spi1EnablePos + bus_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+unsigned AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getFreq(
+    unsigned sysFreq) const
+{
+    auto speed =
+        (cntl0Cache_ & genMask(CNTL0_SPEED_Pos, CNTL0_SPEED_Len)) >> CNTL0_SPEED_Pos;
+    return sysFreq / (2 * (speed + 1));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFreq(
+    unsigned sysFreq,
+    unsigned busFreq)
+{
+    GASSERT(0 < busFreq);
+    // Round the divider up to not exceed the requested frequency
+    auto div = (sysFreq + (2 * busFreq) - 1) / (2 * busFreq);
+    EntryType speed = 0;
+    if (1 < div) {
+        speed = std::min<EntryType>(
+            static_cast<EntryType>(div - 1),
+            genMask(0, CNTL0_SPEED_Len));
+    }
+
+    cntl0Cache_ &= ~genMask(CNTL0_SPEED_Pos, CNTL0_SPEED_Len);
+    cntl0Cache_ |= (speed << CNTL0_SPEED_Pos);
+    *reg(CNTL0_Offset) = cntl0Cache_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+typename AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::Mode
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getMode() const
+{
+    auto modeBits = cntl0Cache_ & CNTL0_ModeMask;
+    if (modeBits == genMask(CNTL0_OUT_RISING_Pos)) {
+        return Mode1;
+    }
+
+    if (modeBits == (genMask(CNTL0_CPOL_Pos) | genMask(CNTL0_OUT_RISING_Pos))) {
+        return Mode2;
+    }
+
+    if (modeBits == (genMask(CNTL0_CPOL_Pos) | genMask(CNTL0_IN_RISING_Pos))) {
+        return Mode3;
+    }
+
+    return Mode0;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setMode(Mode mode)
+{
+    GASSERT(mode < NumOfModes);
+    static const EntryType ModeBits[NumOfModes] = {
+        /* Mode0 */ genMask(CNTL0_IN_RISING_Pos),
+        /* Mode1 */ genMask(CNTL0_OUT_RISING_Pos),
+        /* Mode2 */ genMask(CNTL0_CPOL_Pos) | genMask(CNTL0_OUT_RISING_Pos),
+        /* Mode3 */ genMask(CNTL0_CPOL_Pos) | genMask(CNTL0_IN_RISING_Pos)
+    };
+
+    cntl0Cache_ &= ~CNTL0_ModeMask;
+    cntl0Cache_ |= ModeBits[mode];
+    *reg(CNTL0_Offset) = cntl0Cache_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+typename AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::CharType
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getFillChar() const
+{
+    return fillChar_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFillChar(
+    CharType ch)
+{
+    fillChar_ = ch;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+template <typename TFunc>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+setCanReadHandler(
+    TFunc&& func)
+{
+    canReadHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+template <typename TFunc>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+setCanWriteHandler(
+    TFunc&& func)
+{
+    canWriteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+template <typename TFunc>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+setReadCompleteHandler(
+    TFunc&& func)
+{
+    readCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+template <typename TFunc>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+setWriteCompleteHandler(
+    TFunc&& func)
+{
+    writeCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
+    DeviceIdType id,
+    std::size_t length,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    startReadInternal(id, length);
+    enableInterrupts();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
+    DeviceIdType id,
+    std::size_t length,
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    startReadInternal(id, length);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    bool result = cancelReadInternal();
+    enableInterrupts();
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    return cancelReadInternal();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
+    DeviceIdType id,
+    std::size_t length,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    startWriteInternal(id, length);
+    enableInterrupts();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
+    DeviceIdType id,
+    std::size_t length,
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    startWriteInternal(id, length);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    bool result = cancelWriteInternal();
+    enableInterrupts();
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    return cancelWriteInternal();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::suspend(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    return (readOpInProgress() || writeOpInProgress());
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::resume(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(readOpInProgress() || writeOpInProgress());
+    enableInterrupts();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canRead(
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    GASSERT(readFifoSize_ <= remainingReadLen_);
+    return (0 < readFifoSize_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canWrite(
+    InterruptContext context)
+{
+    static_cast<void>(context);
+    GASSERT(writeFifoSize_ <= remainingWriteLen_);
+    return (0 < writeFifoSize_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+typename AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::CharType
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::read(
+    InterruptContext context)
+{
+    GASSERT(canRead(context));
+    static_cast<void>(context);
+    GASSERT(chunkIdx_ < chunk_.size());
+    --readFifoSize_;
+    --remainingReadLen_;
+    auto ch = chunk_[chunkIdx_];
+    ++chunkIdx_;
+    return ch;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::write(
+    CharType value,
+    InterruptContext context)
+{
+    GASSERT(canWrite(context));
+    static_cast<void>(context);
+    GASSERT(chunkIdx_ < chunk_.size());
+    --writeFifoSize_;
+    --remainingWriteLen_;
+    chunk_[chunkIdx_] = value;
+    ++chunkIdx_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::interruptHandler()
+{
+    if (!transferActive_) {
+        return;
+    }
+
+    auto stat = *reg(STAT_Offset);
+    if (((stat & genMask(STAT_BUSY_Pos)) != 0) ||
+        ((stat & genMask(STAT_TX_EMPTY_Pos)) == 0)) {
+        return; // Not idle yet
+    }
+
+    receiveChunk();
+
+    if ((!readOpInProgress()) && (!writeOpInProgress())) {
+        stopTransfer();
+        return;
+    }
+
+    transmitChunk();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+volatile typename AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::EntryType*
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reg(
+    std::size_t offset) const
+{
+    EntryType base = Spi1Base;
+    if (bus_ == Bus_Spi2) {
+        base = Spi2Base;
+    }
+    return reinterpret_cast<volatile EntryType*>(base + offset);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::selectChip(
+    DeviceIdType id)
+{
+    GASSERT(id < SupportedDeviceIdsCount);
+
+    // Active low, the selected line is cleared in the pattern
+    static const auto Mask = genMask(CNTL0_CS_Pos, CNTL0_CS_Len);
+    cntl0Cache_ |= Mask;
+    cntl0Cache_ &= ~genMask(CNTL0_CS_Pos + id);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+typename AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::DeviceIdType
+AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getChip() const
+{
+    auto pattern =
+        (~cntl0Cache_ & genMask(CNTL0_CS_Pos, CNTL0_CS_Len)) >> CNTL0_CS_Pos;
+    DeviceIdType id = 0;
+    while ((1U < pattern) && (id < SupportedDeviceIdsCount)) {
+        pattern >>= 1;
+        ++id;
+    }
+    return id;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startReadInternal(
+    DeviceIdType id,
+    std::size_t length)
+{
+    GASSERT(remainingReadLen_ == 0);
+    GASSERT(0 < length);
+    remainingReadLen_ = length;
+    if (!transferActive_) {
+        beginTransfer(id);
+    }
+    else {
+        GASSERT(getChip() == id);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWriteInternal(
+    DeviceIdType id,
+    std::size_t length)
+{
+    GASSERT(remainingWriteLen_ == 0);
+    GASSERT(0 < length);
+    remainingWriteLen_ = length;
+    if (!transferActive_) {
+        beginTransfer(id);
+    }
+    else {
+        GASSERT(getChip() == id);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelReadInternal()
+{
+    bool result = false;
+    if (readOpInProgress()) {
+        remainingReadLen_ = 0;
+        result = true;
+    }
+
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWriteInternal()
+{
+    bool result = false;
+    if (writeOpInProgress()) {
+        remainingWriteLen_ = 0;
+        result = true;
+    }
+
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::disableInterrupts()
+{
+    // The AUX interrupt is shared, the SPI interrupt is gated in the
+    // peripheral itself.
+    interruptsEnabled_ = false;
+    *reg(CNTL1_Offset) &= ~genMask(CNTL1_IDLE_IRQ_Pos);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::enableInterrupts()
+{
+    interruptsEnabled_ = true;
+    if (transferActive_) {
+        *reg(CNTL1_Offset) |= genMask(CNTL1_IDLE_IRQ_Pos);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::beginTransfer(
+    DeviceIdType id)
+{
+    GASSERT(writeOpInProgress() || readOpInProgress());
+    GASSERT(!transferActive_);
+    selectChip(id);
+    *reg(CNTL0_Offset) = cntl0Cache_ | genMask(CNTL0_CLEARFIFO_Pos);
+    *reg(CNTL0_Offset) = cntl0Cache_;
+    chunkIdx_ = 0;
+    chunkReadLen_ = 0;
+    entriesCount_ = 0;
+    transferActive_ = true;
+
+    // The engine is idle, the interrupt fills the FIFO
+    if (interruptsEnabled_) {
+        *reg(CNTL1_Offset) |= genMask(CNTL1_IDLE_IRQ_Pos);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::stopTransfer()
+{
+    transferActive_ = false;
+    *reg(CNTL1_Offset) &= ~genMask(CNTL1_IDLE_IRQ_Pos);
+    if (csHeld_) {
+        // Cancelled in the middle, re-enable to release the chip select
+        *reg(CNTL0_Offset) = cntl0Cache_ & ~genMask(CNTL0_ENABLE_Pos);
+        *reg(CNTL0_Offset) = cntl0Cache_;
+        csHeld_ = false;
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::receiveChunk()
+{
+    std::size_t receivedLen = 0;
+    for (std::size_t entryIdx = 0; entryIdx < entriesCount_; ++entryIdx) {
+        auto stat = *reg(STAT_Offset);
+        GASSERT((stat & genMask(STAT_RX_EMPTY_Pos)) == 0);
+        if ((stat & genMask(STAT_RX_EMPTY_Pos)) != 0) {
+            break;
+        }
+
+        // Received bits are right aligned
+        auto data = *reg(IO_Offset);
+        auto entryLen = entryLens_[entryIdx];
+        for (std::size_t idx = 0; idx < entryLen; ++idx) {
+            auto shift = (entryLen - 1 - idx) * 8;
+            chunk_[receivedLen] = static_cast<CharType>(data >> shift);
+            ++receivedLen;
+        }
+    }
+    entriesCount_ = 0;
+
+    chunkIdx_ = 0;
+    readFifoSize_ =
+        std::min(std::min(chunkReadLen_, receivedLen), remainingReadLen_);
+    chunkReadLen_ = 0;
+
+    bool reading = (0 < readFifoSize_);
+    if (reading) {
+        GASSERT(canReadHandler_);
+        canReadHandler_();
+    }
+
+    // The rest of the received characters are discarded
+    readFifoSize_ = 0;
+    if (reading && (!readOpInProgress())) {
+        reportReadComplete(embxx::error::ErrorCode::Success);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::transmitChunk()
+{
+    auto chunkLen = std::min(
+        std::max(remainingReadLen_, remainingWriteLen_),
+        chunk_.size());
+    GASSERT(0 < chunkLen);
+    chunkReadLen_ = std::min(chunkLen, remainingReadLen_);
+
+    chunkIdx_ = 0;
+    writeFifoSize_ = std::min(chunkLen, remainingWriteLen_);
+    bool writing = (0 < writeFifoSize_);
+    if (writing) {
+        GASSERT(canWriteHandler_);
+        canWriteHandler_();
+    }
+
+    writeFifoSize_ = 0;
+    while (chunkIdx_ < chunkLen) {
+        chunk_[chunkIdx_] = fillChar_;
+        ++chunkIdx_;
+    }
+
+    if (writing && (!writeOpInProgress())) {
+        reportWriteComplete(embxx::error::ErrorCode::Success);
+    }
+
+    // New operation may have been started by the completion handler
+    bool lastChunk =
+        ((remainingReadLen_ - chunkReadLen_) == 0) &&
+        (!writeOpInProgress());
+
+    std::size_t pos = 0;
+    while (pos < chunkLen) {
+        auto entryLen = chunkLen - pos;
+        if (MaxCharsPerEntry < entryLen) {
+            entryLen = MaxCharsPerEntry;
+        }
+        auto data = static_cast<EntryType>(entryLen * 8) << VarWidthPos;
+        for (std::size_t idx = 0; idx < entryLen; ++idx) {
+            auto shift = (MaxCharsPerEntry - 1 - idx) * 8;
+            data |= static_cast<EntryType>(chunk_[pos + idx]) << shift;
+        }
+        pos += entryLen;
+
+        GASSERT(entriesCount_ < entryLens_.size());
+        entryLens_[entriesCount_] = entryLen;
+        ++entriesCount_;
+
+        auto offset = TXHOLD_Offset;
+        if (lastChunk && (pos == chunkLen)) {
+            offset = IO_Offset;
+        }
+        *reg(offset) = data;
+    }
+    csHeld_ = !lastChunk;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportReadComplete(
+    const embxx::error::ErrorStatus& es)
+{
+    GASSERT(readCompleteHandler_);
+    remainingReadLen_ = 0;
+    readCompleteHandler_(es);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportWriteComplete(
+    const embxx::error::ErrorStatus& es)
+{
+    GASSERT(writeCompleteHandler_);
+    remainingWriteLen_ = 0;
+    writeCompleteHandler_(es);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::readOpInProgress() const
+{
+    return (0 < remainingReadLen_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool AuxSpi<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::writeOpInProgress() const
+{
+    return (0 < remainingWriteLen_);
+}
+
+}  // namespace device
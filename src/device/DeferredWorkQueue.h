@@ -0,0 +1,246 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "embxx/util/Assert.h"
+#include "embxx/util/StaticFunction.h"
+
+#include "EventLoopDevices.h"
+
+namespace device
+{
+
+/// @brief Lock-free queue of work items deferred from interrupt context
+///        ("bottom halves") to be executed in the event loop context.
+/// @details The interrupt handlers (producers, possibly nested) reserve
+///          the slots using LDREX/STREX without disabling the interrupts,
+///          the event loop (single consumer) executes the posted items in
+///          the order of slot reservation. Use DeferredWaitCond as a wait
+///          condition of the event loop to drain the queue. Relies on the
+///          interrupt handlers (see startup.s) clearing the exclusive
+///          monitor on return.
+/// @tparam TSize Queue capacity, must be power of 2.
+/// @tparam TWork Type of the work item functor.
+template <std::size_t TSize,
+          typename TWork = embxx::util::StaticFunction<void (), sizeof(void*) * 3> >
+class DeferredWorkQueue
+{
+public:
+    typedef TWork Work;
+    static const std::size_t Size = TSize;
+
+    static_assert((0 < Size) && ((Size & (Size - 1)) == 0),
+        "Size must be power of 2");
+
+    DeferredWorkQueue();
+
+    /// @brief Post work item, callable from interrupt context only.
+    /// @return true on success, false if queue is full.
+    template <typename TFunc>
+    bool postInterruptCtx(TFunc&& func);
+
+    /// @brief Execute all the posted work items, callable from
+    ///        event loop context only.
+    /// @return Number of executed items.
+    std::size_t run();
+
+    bool isEmpty() const;
+
+private:
+    typedef std::uint32_t IndexType;
+
+    struct Slot
+    {
+        Slot() : ready_(false) {}
+
+        Work work_;
+        volatile bool ready_;
+    };
+
+    typedef std::array<Slot, Size> Slots;
+
+    bool reserveSlot(IndexType& idx);
+    static IndexType toSlotIdx(IndexType idx);
+    static void compilerBarrier();
+
+    Slots slots_;
+    volatile IndexType head_; // Next slot to reserve
+    volatile IndexType tail_; // Next slot to execute
+};
+
+/// @brief Wait condition for the event loop, that executes the deferred
+///        work items before going to sleep.
+/// @details The event loop doesn't provide access to its wait condition
+///          object, the queue must be assigned using setQueue() before
+///          the event loop is started.
+template <typename TQueue, typename TWaitCond = WaitCond>
+class DeferredWaitCond
+{
+public:
+    typedef TQueue Queue;
+
+    static void setQueue(Queue& queue);
+
+    template <typename TLock>
+    void wait(TLock& lock);
+
+    void notify();
+
+private:
+    TWaitCond cond_;
+    static Queue* queue_;
+};
+
+// Implementation
+
+template <std::size_t TSize, typename TWork>
+DeferredWorkQueue<TSize, TWork>::DeferredWorkQueue()
+    : head_(0),
+      tail_(0)
+{
+}
+
+template <std::size_t TSize, typename TWork>
+template <typename TFunc>
+bool DeferredWorkQueue<TSize, TWork>::postInterruptCtx(TFunc&& func)
+{
+    IndexType idx = 0;
+    if (!reserveSlot(idx)) {
+        return false;
+    }
+
+    auto& slot = slots_[toSlotIdx(idx)];
+    GASSERT(!slot.ready_);
+    slot.work_ = std::forward<TFunc>(func);
+    compilerBarrier();
+    slot.ready_ = true;
+    return true;
+}
+
+template <std::size_t TSize, typename TWork>
+std::size_t DeferredWorkQueue<TSize, TWork>::run()
+{
+    std::size_t count = 0;
+    while (true) {
+        auto& slot = slots_[toSlotIdx(tail_)];
+        if (!slot.ready_) {
+            // Either empty or the producer hasn't finished posting yet
+            break;
+        }
+
+        compilerBarrier();
+        GASSERT(slot.work_);
+        slot.work_();
+        slot.work_ = Work();
+        slot.ready_ = false;
+        compilerBarrier();
+        tail_ = tail_ + 1;
+        ++count;
+    }
+    return count;
+}
+
+template <std::size_t TSize, typename TWork>
+bool DeferredWorkQueue<TSize, TWork>::isEmpty() const
+{
+    return head_ == tail_;
+}
+
+template <std::size_t TSize, typename TWork>
+bool DeferredWorkQueue<TSize, TWork>::reserveSlot(IndexType& idx)
+{
+    std::uint32_t failed = 0;
+    do {
+        __asm volatile(
+            "ldrex %0, [%1]"
+            : "=&r" (idx)
+            : "r" (&head_)
+            : "memory");
+
+        if (Size <= (idx - tail_)) {
+            // Clear the exclusive monitor, otherwise STREX of the preempted
+            // (lower priority) producer succeeds with its stale index. The
+            // value is unchanged, the store is harmless if it succeeds.
+            __asm volatile(
+                "strex %0, %2, [%1]"
+                : "=&r" (failed)
+                : "r" (&head_), "r" (idx)
+                : "memory");
+            return false;
+        }
+
+        __asm volatile(
+            "strex %0, %2, [%1]"
+            : "=&r" (failed)
+            : "r" (&head_), "r" (idx + 1)
+            : "memory");
+    } while (failed != 0);
+    return true;
+}
+
+template <std::size_t TSize, typename TWork>
+typename DeferredWorkQueue<TSize, TWork>::IndexType
+DeferredWorkQueue<TSize, TWork>::toSlotIdx(IndexType idx)
+{
+    return idx & static_cast<IndexType>(Size - 1);
+}
+
+template <std::size_t TSize, typename TWork>
+void DeferredWorkQueue<TSize, TWork>::compilerBarrier()
+{
+    // Single core, there is no need for memory barrier instruction
+    __asm volatile("" : : : "memory");
+}
+
+template <typename TQueue, typename TWaitCond>
+typename DeferredWaitCond<TQueue, TWaitCond>::Queue*
+DeferredWaitCond<TQueue, TWaitCond>::queue_ = nullptr;
+
+template <typename TQueue, typename TWaitCond>
+void DeferredWaitCond<TQueue, TWaitCond>::setQueue(Queue& queue)
+{
+    queue_ = &queue;
+}
+
+template <typename TQueue, typename TWaitCond>
+template <typename TLock>
+void DeferredWaitCond<TQueue, TWaitCond>::wait(TLock& lock)
+{
+    // Invoked with the lock held, the work items are executed with
+    // interrupts enabled.
+    if ((queue_ != nullptr) && (!queue_->isEmpty())) {
+        lock.unlock();
+        queue_->run();
+        lock.lock();
+        return; // Executed items may post new events, don't sleep
+    }
+
+    cond_.wait(lock);
+}
+
+template <typename TQueue, typename TWaitCond>
+void DeferredWaitCond<TQueue, TWaitCond>::notify()
+{
+    cond_.notify();
+}
+
+}  // namespace device
@@ -0,0 +1,387 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "embxx/util/Assert.h"
+#include "embxx/util/StaticFunction.h"
+#include "embxx/error/ErrorStatus.h"
+
+namespace device
+{
+
+/// @brief Single channel of the DMA controller.
+/// @details Performs transfers between memory and peripheral FIFO paced by
+///          the DREQ signal of the peripheral. The peripheral register is
+///          always accessed with 32 bit width, the meaning of the
+///          transferred words is defined by the peripheral (single
+///          character per word for the UART, 4 packed bytes for the SPI).
+///          The ARM caches are not enabled by the startup code, no cache
+///          maintenance is performed.
+/// @tparam TInterruptMgr Interrupt manager, the channel must have its
+///         interrupt source defined (see InterruptIds).
+/// @tparam TCompleteHandler Type of the transfer completion callback.
+template <typename TInterruptMgr,
+          typename TCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)> >
+class DmaChannel
+{
+public:
+    typedef TInterruptMgr InterruptMgr;
+    typedef TCompleteHandler CompleteHandler;
+    typedef typename InterruptMgr::IrqId IrqId;
+    typedef std::uint32_t WordType;
+
+    /// @brief Peripheral DREQ signals.
+    enum Peripheral {
+        Peripheral_None = 0,
+        Peripheral_SpiTx = 6,
+        Peripheral_SpiRx = 7,
+        Peripheral_UartTx = 12,
+        Peripheral_UartRx = 14
+    };
+
+    DmaChannel(InterruptMgr& interruptMgr, std::size_t channel);
+
+    ~DmaChannel();
+
+    template <typename TFunc>
+    void setCompleteHandler(TFunc&& func);
+
+    /// @brief Start transfer from memory to peripheral register.
+    /// @param src Source buffer, must be word aligned.
+    /// @param periphReg Peripheral register (physical address).
+    /// @param length Number of bytes to transfer, multiple of word size.
+    /// @param periph DREQ signal pacing the transfer.
+    /// @param srcInc When false, the same source word is written
+    ///        repeatedly.
+    void startWrite(
+        const void* src,
+        volatile WordType* periphReg,
+        std::size_t length,
+        Peripheral periph,
+        bool srcInc = true);
+
+    /// @brief Start transfer from peripheral register to memory.
+    /// @param periphReg Peripheral register (physical address).
+    /// @param dest Destination buffer, must be word aligned.
+    /// @param length Number of bytes to transfer, multiple of word size.
+    /// @param periph DREQ signal pacing the transfer.
+    /// @param destInc When false, all the words are written into the same
+    ///        destination word.
+    void startRead(
+        const volatile WordType* periphReg,
+        void* dest,
+        std::size_t length,
+        Peripheral periph,
+        bool destInc = true);
+
+    /// @brief Abort the transfer in progress.
+    /// @return true if the transfer was in progress, the completion
+    ///         callback is not invoked in this case.
+    bool cancel();
+
+    bool isActive() const;
+
+    /// @brief Number of bytes not transferred yet by the active or
+    ///        cancelled transfer.
+    std::size_t getRemaining() const;
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
+private:
+    typedef WordType EntryType;
+
+    struct alignas(32) ControlBlock
+    {
+        EntryType transferInfo_;
+        EntryType sourceAddr_;
+        EntryType destAddr_;
+        EntryType transferLength_;
+        EntryType stride_;
+        EntryType nextControlBlock_;
+        EntryType reserved_[2];
+    };
+
+    static IrqId channelToIrqId(std::size_t channel);
+    static EntryType toBusAddr(const volatile void* periphReg);
+    static EntryType toBusAddr(const void* mem);
+    volatile EntryType* reg(std::size_t offset) const;
+    void start(EntryType transferInfo, std::size_t length);
+    void reset();
+
+    InterruptMgr& interruptMgr_;
+    std::size_t channel_;
+    IrqId irqId_;
+    CompleteHandler completeHandler_;
+    ControlBlock controlBlock_;
+    std::size_t remaining_;
+
+    static constexpr EntryType genMask(std::size_t pos, std::size_t len = 1)
+    {
+        return ((static_cast<EntryType>(1) << len) - 1) << pos;
+    }
+
+    static const EntryType DmaBase = 0x20007000;
+    static const std::size_t ChannelRegsSize = 0x100;
+
+    static constexpr auto pDMA_ENABLE =
+        reinterpret_cast<volatile EntryType*>(0x20007FF0);
+
+    static const EntryType PeriphPhysBase = 0x20000000;
+    static const EntryType PeriphBusBase = 0x7E000000;
+    static const EntryType MemBusBase = 0x40000000; // L2 cache coherent alias
+
+    // Channel registers
+    static const std::size_t CsRegOffset = 0x00;
+    static const std::size_t ActivePos = 0;
+    static const std::size_t EndPos = 1;
+    static const std::size_t IntPos = 2;
+    static const std::size_t ErrorPos = 8;
+    static const std::size_t PriorityPos = 16;
+    static const std::size_t PriorityLen = 4;
+    static const std::size_t PanicPriorityPos = 20;
+    static const std::size_t PanicPriorityLen = 4;
+    static const std::size_t WaitForOutstandingWritesPos = 28;
+    static const std::size_t ResetPos = 31;
+    static const EntryType DefaultPriority = 8;
+    static const EntryType DefaultPanicPriority = 15;
+
+    static const std::size_t ControlBlockAddrRegOffset = 0x04;
+    static const std::size_t TransferLengthRegOffset = 0x14;
+    static const std::size_t DebugRegOffset = 0x20;
+    static const EntryType DebugErrorsMask = genMask(0, 3);
+
+    // Transfer information bits
+    static const std::size_t IntEnablePos = 0;
+    static const std::size_t WaitRespPos = 3;
+    static const std::size_t DestIncPos = 4;
+    static const std::size_t DestDreqPos = 6;
+    static const std::size_t SrcIncPos = 8;
+    static const std::size_t SrcDreqPos = 10;
+    static const std::size_t PermapPos = 16;
+    static const std::size_t PermapLen = 5;
+};
+
+// Implementation
+template <typename TInterruptMgr, typename TCompleteHandler>
+DmaChannel<TInterruptMgr, TCompleteHandler>::DmaChannel(
+    InterruptMgr& interruptMgr,
+    std::size_t channel)
+    : interruptMgr_(interruptMgr),
+      channel_(channel),
+      irqId_(channelToIrqId(channel)),
+      remaining_(0)
+{
+    *pDMA_ENABLE |= genMask(channel_);
+    reset();
+
+    interruptMgr_.registerHandler(
+        irqId_,
+        std::bind(&DmaChannel::interruptHandler, this));
+    interruptMgr_.enableInterrupt(irqId_);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+DmaChannel<TInterruptMgr, TCompleteHandler>::~DmaChannel()
+{
+    interruptMgr_.disableInterrupt(irqId_);
+    reset();
+    *pDMA_ENABLE &= ~genMask(channel_);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+template <typename TFunc>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::setCompleteHandler(
+    TFunc&& func)
+{
+    completeHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::startWrite(
+    const void* src,
+    volatile WordType* periphReg,
+    std::size_t length,
+    Peripheral periph,
+    bool srcInc)
+{
+    controlBlock_.sourceAddr_ = toBusAddr(src);
+    controlBlock_.destAddr_ = toBusAddr(periphReg);
+    start(
+        (static_cast<EntryType>(srcInc) << SrcIncPos) |
+        genMask(DestDreqPos) |
+        (static_cast<EntryType>(periph) << PermapPos),
+        length);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::startRead(
+    const volatile WordType* periphReg,
+    void* dest,
+    std::size_t length,
+    Peripheral periph,
+    bool destInc)
+{
+    controlBlock_.sourceAddr_ = toBusAddr(periphReg);
+    controlBlock_.destAddr_ = toBusAddr(dest);
+    start(
+        (static_cast<EntryType>(destInc) << DestIncPos) |
+        genMask(SrcDreqPos) |
+        (static_cast<EntryType>(periph) << PermapPos),
+        length);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+bool DmaChannel<TInterruptMgr, TCompleteHandler>::cancel()
+{
+    if (!isActive()) {
+        return false;
+    }
+
+    // Pause first to read the consistent remaining length
+    *reg(CsRegOffset) &= ~genMask(ActivePos);
+    remaining_ = *reg(TransferLengthRegOffset);
+    reset();
+    return true;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+bool DmaChannel<TInterruptMgr, TCompleteHandler>::isActive() const
+{
+    return (*reg(CsRegOffset) & genMask(ActivePos)) != 0;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+std::size_t DmaChannel<TInterruptMgr, TCompleteHandler>::getRemaining() const
+{
+    if (isActive()) {
+        return *reg(TransferLengthRegOffset);
+    }
+    return remaining_;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::interruptHandler()
+{
+    auto cs = *reg(CsRegOffset);
+    if ((cs & genMask(IntPos)) == 0) {
+        return;
+    }
+
+    // Clear the interrupt and end flags
+    *reg(CsRegOffset) = genMask(IntPos) | genMask(EndPos);
+
+    auto status = embxx::error::ErrorCode::Success;
+    if ((cs & genMask(ErrorPos)) != 0) {
+        remaining_ = *reg(TransferLengthRegOffset);
+        *reg(DebugRegOffset) = DebugErrorsMask;
+        status = embxx::error::ErrorCode::HwProtocolError;
+    }
+    else {
+        remaining_ = 0;
+    }
+
+    if (completeHandler_) {
+        completeHandler_(status);
+    }
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+typename DmaChannel<TInterruptMgr, TCompleteHandler>::IrqId
+DmaChannel<TInterruptMgr, TCompleteHandler>::channelToIrqId(
+    std::size_t channel)
+{
+    if (channel == 4) {
+        return IrqId::IrqId_Dma4;
+    }
+
+    GASSERT(channel == 5); // Other channels are not supported
+    return IrqId::IrqId_Dma5;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+typename DmaChannel<TInterruptMgr, TCompleteHandler>::EntryType
+DmaChannel<TInterruptMgr, TCompleteHandler>::toBusAddr(
+    const volatile void* periphReg)
+{
+    auto addr = static_cast<EntryType>(
+        reinterpret_cast<std::uintptr_t>(periphReg));
+    GASSERT(PeriphPhysBase <= addr);
+    return (addr - PeriphPhysBase) + PeriphBusBase;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+typename DmaChannel<TInterruptMgr, TCompleteHandler>::EntryType
+DmaChannel<TInterruptMgr, TCompleteHandler>::toBusAddr(const void* mem)
+{
+    auto addr = static_cast<EntryType>(reinterpret_cast<std::uintptr_t>(mem));
+    GASSERT((addr & genMask(0, 2)) == 0);
+    return addr | MemBusBase;
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+volatile typename DmaChannel<TInterruptMgr, TCompleteHandler>::EntryType*
+DmaChannel<TInterruptMgr, TCompleteHandler>::reg(std::size_t offset) const
+{
+    return reinterpret_cast<volatile EntryType*>(
+        DmaBase + (channel_ * ChannelRegsSize) + offset);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::start(
+    EntryType transferInfo,
+    std::size_t length)
+{
+    GASSERT(!isActive());
+    GASSERT(0 < length);
+    GASSERT((length & genMask(0, 2)) == 0);
+
+    controlBlock_.transferInfo_ =
+        transferInfo |
+        genMask(IntEnablePos) |
+        genMask(WaitRespPos);
+    controlBlock_.transferLength_ = static_cast<EntryType>(length);
+    controlBlock_.stride_ = 0;
+    controlBlock_.nextControlBlock_ = 0;
+    remaining_ = length;
+
+    // Control block must be written to memory before the DMA reads it
+    __asm volatile("" : : : "memory");
+    *reg(ControlBlockAddrRegOffset) = toBusAddr(&controlBlock_);
+    *reg(CsRegOffset) =
+        genMask(ActivePos) |
+        (DefaultPriority << PriorityPos) |
+        (DefaultPanicPriority << PanicPriorityPos) |
+        genMask(WaitForOutstandingWritesPos);
+}
+
+template <typename TInterruptMgr, typename TCompleteHandler>
+void DmaChannel<TInterruptMgr, TCompleteHandler>::reset()
+{
+    *reg(CsRegOffset) = genMask(ResetPos);
+    *reg(CsRegOffset) = genMask(IntPos) | genMask(EndPos);
+    *reg(DebugRegOffset) = DebugErrorsMask;
+}
+
+}  // namespace device
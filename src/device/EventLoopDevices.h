@@ -18,18 +18,28 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
 #include "embxx/util/Assert.h"
 #include "InterruptMgr.h"
+#include "FreeRunningCounter.h"
 
 namespace device
 {
 
-class InterruptLock
+/// @brief Event loop lock that disables the interrupts globally.
+/// @tparam TNested Whether the interrupt handlers posting to the event loop
+///         may be pre-empted by other ones: more than one priority level
+///         in InterruptMgr or handler executed in FIQ context (see
+///         InterruptMgr::routeToFiq()). When false the interrupt context
+///         lock is a no-op.
+template <bool TNested>
+class BasicInterruptLock
 {
 public:
-    InterruptLock()
-        : flags_(0)
+    BasicInterruptLock()
+        : flags_(0),
+          ctxFlags_(0)
 #ifndef NDEBUG
           , locked_(0)
 #endif
@@ -58,21 +68,186 @@ public:
 
     void lockInterruptCtx()
     {
-        // Nothing to do
+        lockInterruptCtxInternal(NestedTag());
     }
 
     void unlockInterruptCtx()
     {
-        // Nothing to do
+        unlockInterruptCtxInternal(NestedTag());
     }
+
 private:
+    struct FlatTag {};
+    struct PreemptableTag {};
+    typedef typename std::conditional<
+        TNested,
+        PreemptableTag,
+        FlatTag
+    >::type NestedTag;
+
+    void lockInterruptCtxInternal(FlatTag)
+    {
+        // Nothing to do
+    }
+
+    void unlockInterruptCtxInternal(FlatTag)
+    {
+        // Nothing to do
+    }
+
+    void lockInterruptCtxInternal(PreemptableTag)
+    {
+        // Mask interrupts to prevent concurrent access from the handler
+        // of higher priority.
+        ctxFlags_ = device::interrupt::save();
+        device::interrupt::disable();
+    }
+
+    void unlockInterruptCtxInternal(PreemptableTag)
+    {
+        device::interrupt::restore(ctxFlags_);
+    }
+
     volatile std::uint32_t flags_;
+    device::interrupt::Flags ctxFlags_;
 #ifndef NDEBUG
     bool locked_;
 #endif
     static const std::uint32_t IntMask = 1U << 7;
 };
 
+/// @brief Lock for flat interrupts dispatch, handlers are never pre-empted.
+typedef BasicInterruptLock<false> InterruptLock;
+
+/// @brief Lock for nested interrupts dispatch or FIQ posting to event loop.
+typedef BasicInterruptLock<true> NestedInterruptLock;
+
+/// @brief Event loop lock that masks only lockable interrupt sources.
+/// @details Uses InterruptMgr::lockSources() instead of global disabling
+///          of the interrupts, the sources excluded by
+///          InterruptMgr::setLockable() keep running while the lock is
+///          held. Until the interrupt manager is assigned using
+///          setInterruptMgr(), the interrupts are disabled globally.
+///          Must be used with SelectiveWaitCond.
+template <typename TInterruptMgr>
+class SelectiveInterruptLock
+{
+public:
+    typedef TInterruptMgr InterruptMgr;
+
+    SelectiveInterruptLock()
+        : globalLocked_(false),
+          globalCtxLocked_(false)
+    {
+    }
+
+    static void setInterruptMgr(InterruptMgr& interruptMgr)
+    {
+        interruptMgr_ = &interruptMgr;
+    }
+
+    void lock()
+    {
+        if (interruptMgr_ == nullptr) {
+            globalLock_.lock();
+            globalLocked_ = true;
+            return;
+        }
+
+        interruptMgr_->lockSources();
+    }
+
+    void unlock()
+    {
+        if (globalLocked_) {
+            globalLocked_ = false;
+            globalLock_.unlock();
+            return;
+        }
+
+        GASSERT(interruptMgr_ != nullptr);
+        interruptMgr_->unlockSources();
+    }
+
+    void lockInterruptCtx()
+    {
+        if (interruptMgr_ == nullptr) {
+            globalLock_.lockInterruptCtx();
+            globalCtxLocked_ = true;
+            return;
+        }
+
+        interruptMgr_->lockSources();
+    }
+
+    void unlockInterruptCtx()
+    {
+        if (globalCtxLocked_) {
+            globalCtxLocked_ = false;
+            globalLock_.unlockInterruptCtx();
+            return;
+        }
+
+        GASSERT(interruptMgr_ != nullptr);
+        interruptMgr_->unlockSources();
+    }
+
+private:
+    NestedInterruptLock globalLock_;
+    bool globalLocked_;
+    bool globalCtxLocked_;
+    static InterruptMgr* interruptMgr_;
+};
+
+template <typename TInterruptMgr>
+TInterruptMgr* SelectiveInterruptLock<TInterruptMgr>::interruptMgr_ = nullptr;
+
+/// @brief Low power idle of the core with idle/active residency accounting.
+/// @details There is no periodic tick, the timer is armed by the
+///          TimerMgr for its nearest deadline only, so the core sleeps
+///          until either that deadline or any other interrupt.
+///          The residency is measured in ticks of TCounter (see
+///          FreeRunningCounter) at the rate configured by the application,
+///          single idle or active period longer than the counter wrap
+///          around time (2^32 ticks, ~17 seconds without prescaler) is not
+///          accounted properly.
+template <typename TCounter>
+class BasicIdle
+{
+public:
+    typedef std::uint64_t TicksType;
+
+    /// @brief Enter low power state until an interrupt becomes pending.
+    /// @details Expected to be called with interrupts disabled in CPSR,
+    ///          pending interrupt wakes up the core even when masked.
+    static void sleep();
+
+    static TicksType getIdleTicks();
+
+    static TicksType getActiveTicks();
+
+    /// @brief Get frequency of the ticks in Hz.
+    static unsigned getTicksFrequency();
+
+    /// @brief Get the active time in percents of the total time since
+    ///        last reset().
+    static unsigned getUtilisation();
+
+    static void reset();
+
+private:
+    typedef typename TCounter::TicksType CounterTicksType;
+
+    static void waitForInterrupt();
+
+    static TicksType idleTicks_;
+    static TicksType activeTicks_;
+    static CounterTicksType lastTicks_;
+    static bool started_;
+};
+
+typedef BasicIdle<FreeRunningCounter> Idle;
+
 class WaitCond
 {
 public:
@@ -80,7 +255,33 @@ public:
     void wait(TLock& lock)
     {
         static_cast<void>(lock);
-        __asm volatile("wfi"); // probably has no effect
+        Idle::sleep();
+    }
+
+    void notify()
+    {
+        // Nothing to do, the notification comes from interrupt context
+        // and the core is already awake.
+    }
+};
+
+/// @brief Wait condition to be used with SelectiveInterruptLock.
+/// @details The lockable sources are masked in the interrupt controller
+///          while the lock is held and won't wake up the processor, the
+///          lock is released for the duration of the wait with interrupts
+///          disabled globally instead.
+class SelectiveWaitCond
+{
+public:
+    template <typename TLock>
+    void wait(TLock& lock)
+    {
+        auto flags = device::interrupt::save();
+        device::interrupt::disable();
+        lock.unlock();
+        Idle::sleep();
+        lock.lock();
+        device::interrupt::restore(flags);
     }
 
     void notify()
@@ -89,4 +290,91 @@ public:
     }
 };
 
+// Implementation
+
+template <typename TCounter>
+void BasicIdle<TCounter>::sleep()
+{
+    if (!started_) {
+        if (!TCounter::isEnabled()) {
+            TCounter::enable();
+        }
+        reset();
+    }
+
+    auto sleepTicks = TCounter::ticks();
+    activeTicks_ += static_cast<CounterTicksType>(sleepTicks - lastTicks_);
+    waitForInterrupt();
+    auto wakeTicks = TCounter::ticks();
+    idleTicks_ += static_cast<CounterTicksType>(wakeTicks - sleepTicks);
+    lastTicks_ = wakeTicks;
+}
+
+template <typename TCounter>
+unsigned BasicIdle<TCounter>::getTicksFrequency()
+{
+    return TCounter::getFrequency();
+}
+
+template <typename TCounter>
+typename BasicIdle<TCounter>::TicksType BasicIdle<TCounter>::getIdleTicks()
+{
+    return idleTicks_;
+}
+
+template <typename TCounter>
+typename BasicIdle<TCounter>::TicksType BasicIdle<TCounter>::getActiveTicks()
+{
+    if (!started_) {
+        return activeTicks_;
+    }
+
+    // Include currently running active period
+    auto currentTicks =
+        static_cast<CounterTicksType>(TCounter::ticks() - lastTicks_);
+    return activeTicks_ + currentTicks;
+}
+
+template <typename TCounter>
+unsigned BasicIdle<TCounter>::getUtilisation()
+{
+    auto activeTicks = getActiveTicks();
+    auto totalTicks = activeTicks + idleTicks_;
+    if (totalTicks == 0) {
+        return 0;
+    }
+
+    return static_cast<unsigned>((activeTicks * 100) / totalTicks);
+}
+
+template <typename TCounter>
+void BasicIdle<TCounter>::reset()
+{
+    idleTicks_ = 0;
+    activeTicks_ = 0;
+    lastTicks_ = TCounter::ticks();
+    started_ = true;
+}
+
+template <typename TCounter>
+void BasicIdle<TCounter>::waitForInterrupt()
+{
+    // ARM1176 "Wait For Interrupt" CP15 operation, equivalent to the "wfi"
+    // hint. The CP15 form is used for compatibility with assemblers
+    // which don't accept "wfi" for ARMv6 (the build uses -march=armv6z).
+    __asm volatile("mcr p15, 0, %0, c7, c0, 4" : : "r" (0) : "memory");
+}
+
+template <typename TCounter>
+typename BasicIdle<TCounter>::TicksType BasicIdle<TCounter>::idleTicks_ = 0;
+
+template <typename TCounter>
+typename BasicIdle<TCounter>::TicksType BasicIdle<TCounter>::activeTicks_ = 0;
+
+template <typename TCounter>
+typename BasicIdle<TCounter>::CounterTicksType BasicIdle<TCounter>::lastTicks_ = 0;
+
+template <typename TCounter>
+bool BasicIdle<TCounter>::started_ = false;
+
 }  // namespace device
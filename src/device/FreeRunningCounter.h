@@ -0,0 +1,95 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "embxx/util/Assert.h"
+
+namespace device
+{
+
+/// @brief Free running counter of the ARM timer.
+/// @details The counter is independent of the timer itself (see Timer.h),
+///          it doesn't generate any interrupts and just counts up with
+///          frequency of (system clock / (prescaler + 1)).
+///          The counter is shared by all its users (Idle, InterruptStats,
+///          etc...), its rate belongs to the application. The application
+///          is expected to enable it before any of the users does,
+///          otherwise they enable it without prescaler. The users measure
+///          in ticks of the configured rate (see getFrequency()).
+class FreeRunningCounter
+{
+public:
+    typedef std::uint32_t TicksType;
+
+    /// @brief Clock of the counter (APB clock) before prescaling.
+    static const unsigned ClockFreq = 250000000; // 250MHz
+
+    static void enable(unsigned prescaler = 0)
+    {
+        GASSERT(prescaler <= (ControlRegPrescalerMask >> ControlRegPrescalerPos));
+        auto value = *ControlReg;
+        value &= ~ControlRegPrescalerMask;
+        value |= (static_cast<EntryType>(prescaler) << ControlRegPrescalerPos) & ControlRegPrescalerMask;
+        value |= ControlRegEnableMask;
+        *ControlReg = value;
+    }
+
+    static bool isEnabled()
+    {
+        return (*ControlReg & ControlRegEnableMask) != 0;
+    }
+
+    static unsigned getPrescaler()
+    {
+        return static_cast<unsigned>(
+            (*ControlReg & ControlRegPrescalerMask) >> ControlRegPrescalerPos);
+    }
+
+    /// @brief Get frequency of the ticks in Hz.
+    static unsigned getFrequency()
+    {
+        return ClockFreq / (getPrescaler() + 1);
+    }
+
+    static TicksType ticks()
+    {
+        return *CounterReg;
+    }
+
+private:
+    typedef std::uint32_t EntryType;
+
+    static constexpr volatile EntryType* const ControlReg =
+        reinterpret_cast<volatile EntryType*>(0x2000B408);
+
+    static constexpr const volatile EntryType* const CounterReg =
+        reinterpret_cast<volatile EntryType*>(0x2000B420);
+
+    static const std::size_t ControlRegEnablePos = 9;
+    static const EntryType ControlRegEnableMask =
+        static_cast<EntryType>(1) << ControlRegEnablePos;
+
+    static const std::size_t ControlRegPrescalerPos = 16;
+    static const EntryType ControlRegPrescalerMask =
+        static_cast<EntryType>(0xff) << ControlRegPrescalerPos;
+};
+
+}  // namespace device
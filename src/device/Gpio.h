@@ -33,7 +33,8 @@ namespace device
 {
 
 template <typename TInterruptMgr,
-          typename THandler = embxx::util::StaticFunction<void (Function::PinIdxType, bool)> >
+          typename THandler = embxx::util::StaticFunction<void (Function::PinIdxType, bool)>,
+          typename TDeferredQueue = std::nullptr_t>
 class Gpio
 {
 
@@ -42,6 +43,11 @@ public:
     typedef TInterruptMgr InterruptMgr;
     typedef THandler Handler;
 
+    /// @brief Queue of deferred work (see DeferredWorkQueue).
+    /// @details When provided, the handler is invoked in the event loop
+    ///          context via the queue instead of the interrupt context.
+    typedef TDeferredQueue DeferredQueue;
+
     typedef embxx::device::context::EventLoop EventLoopCtx;
 
     typedef Function::PinIdxType PinIdType;
@@ -59,9 +65,13 @@ public:
         Edge_NumOfEdges // Must be last
     };
 
-    Gpio(InterruptMgr& interruptMgr, Function& func)
+    Gpio(
+        InterruptMgr& interruptMgr,
+        Function& func,
+        DeferredQueue* deferredQueue = nullptr)
       : interruptMgr_(interruptMgr),
         func_(func),
+        deferredQueue_(deferredQueue),
         enabled_(false)
     {
         for (auto& c : edgeConfig) {
@@ -75,27 +85,7 @@ public:
 
             interruptMgr.registerHandler(
                 interruptIdx,
-                [this](){
-                    WordsBundle bundle = *pGPEDS;
-                    *pGPEDS = bundle; // clear all the reported interrupts
-                    for (PinIdType id = 0U; id < NumOfLines; ++id) {
-                        auto* entry = idxToEntry(id, &bundle);
-                        auto mask = idxToEntryBitmask(id);
-                        if ((*entry & mask) == 0) {
-                            continue;
-                        }
-
-                        typedef typename EdgeConfigData::value_type EdgConfigValuetype;
-                        auto value = readPin(id);
-                        auto edgeConfigMask =
-                            static_cast<EdgConfigValuetype>(1) << id;
-                        GASSERT(handler_);
-                        if (((value) && ((edgeConfig[Edge_Rising] & edgeConfigMask) != 0)) ||
-                            ((!value) && ((edgeConfig[Edge_Falling] & edgeConfigMask) != 0))) {
-                            handler_(id, value);
-                        }
-                    }
-                });
+                std::bind(&Gpio::interruptHandler, this));
             setInterruptsEnabled(false);
         }
     }
@@ -214,6 +204,32 @@ public:
         setInterruptsEnabled(true);
     }
 
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler()
+    {
+        WordsBundle bundle = *pGPEDS;
+        *pGPEDS = bundle; // clear all the reported interrupts
+        for (PinIdType id = 0U; id < NumOfLines; ++id) {
+            auto* entry = idxToEntry(id, &bundle);
+            auto mask = idxToEntryBitmask(id);
+            if ((*entry & mask) == 0) {
+                continue;
+            }
+
+            typedef typename EdgeConfigData::value_type EdgConfigValuetype;
+            auto value = readPin(id);
+            auto edgeConfigMask =
+                static_cast<EdgConfigValuetype>(1) << id;
+            GASSERT(handler_);
+            if (((value) && ((edgeConfig[Edge_Rising] & edgeConfigMask) != 0)) ||
+                ((!value) && ((edgeConfig[Edge_Falling] & edgeConfigMask) != 0))) {
+                reportEdge(id, value, deferredQueue_);
+            }
+        }
+    }
+
 private:
 
     typedef std::uint32_t SingleWordType;
@@ -226,6 +242,25 @@ private:
         volatile SingleWordType entries[NumOfWordsInBundle];
     };
 
+    void reportEdge(PinIdType id, bool value, std::nullptr_t* queue)
+    {
+        static_cast<void>(queue);
+        handler_(id, value);
+    }
+
+    template <typename TQueue>
+    void reportEdge(PinIdType id, bool value, TQueue* queue)
+    {
+        GASSERT(queue != nullptr);
+        auto result = queue->postInterruptCtx(
+            [this, id, value]()
+            {
+                handler_(id, value);
+            });
+        GASSERT(result);
+        static_cast<void>(result);
+    }
+
     void setInterruptsEnabled(bool enabled)
     {
         for (int i = 0; i < NumOfInterrupts; ++i) {
@@ -294,6 +329,7 @@ private:
     typedef std::array<std::uint64_t, Edge_NumOfEdges> EdgeConfigData;
     InterruptMgr& interruptMgr_;
     Function& func_;
+    DeferredQueue* deferredQueue_;
     Handler handler_;
     EdgeConfigData edgeConfig;
     bool enabled_;
@@ -322,8 +358,9 @@ private:
 
 
 template <typename TInterruptMgr,
-          typename THandler>
-const Function::FuncSel Gpio<TInterruptMgr, THandler>::DirToFuncSel[Gpio<TInterruptMgr, THandler>::Dir_NumOfDirs] =
+          typename THandler,
+          typename TDeferredQueue>
+const Function::FuncSel Gpio<TInterruptMgr, THandler, TDeferredQueue>::DirToFuncSel[Gpio<TInterruptMgr, THandler, TDeferredQueue>::Dir_NumOfDirs] =
 {
     Function::FuncSel::Input,
     Function::FuncSel::Output
@@ -22,6 +22,7 @@
 #include <cstdint>
 #include <algorithm>
 #include <limits>
+#include <array>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StaticFunction.h"
@@ -55,6 +56,8 @@ public:
 
     typedef typename InterruptMgr::IrqId IrqId;
 
+    static const std::size_t FifoSize = 16;
+
     I2C0(InterruptMgr& interruptMgr, Function& funcDev);
 
     static EntryType getDivider();
@@ -81,6 +84,39 @@ public:
     template <typename TContext>
     bool cancelRead(TContext context);
 
+    /// @brief Attach write phase to the next read from the device.
+    /// @details The next startRead() for the same device address becomes
+    ///          combined transaction: the provided data is written first,
+    ///          then the read is issued with repeated start instead of
+    ///          STOP/START pair (typically used to set EEPROM or register
+    ///          address of the read). The attachment allows such transactions
+    ///          to pass unchanged through generic device adapters and
+    ///          queues, which are aware of read and write operations only.
+    ///          The attachment is consumed by the read, it must be
+    ///          re-attached if the read needs to be repeated. Attaching
+    ///          again to the same address replaces the previous one.
+    ///          The buffer must remain valid until the read is started.
+    /// @param address Device address.
+    /// @param buf Data to write, nullptr removes the existing attachment.
+    /// @param length Length of the write data, mustn't exceed FifoSize.
+    void setWriteBeforeRead(
+        DeviceIdType address,
+        const CharType* buf,
+        std::size_t length);
+
+    /// @brief Attach header to the next write to the device.
+    /// @details The header (typically EEPROM or register address) is sent
+    ///          right before the data of the next startWrite() for the same
+    ///          device address within the same transaction, i.e. without
+    ///          the need to copy the header and the payload into single
+    ///          buffer. Reported written length doesn't include the
+    ///          header. The rest of the rules are the same as for
+    ///          setWriteBeforeRead().
+    void setWriteHeader(
+        DeviceIdType address,
+        const CharType* buf,
+        std::size_t length);
+
     template <typename TContext>
     void startWrite(
         DeviceIdType address,
@@ -98,6 +134,11 @@ public:
     CharType read(InterruptContext context);
     void write(CharType value, InterruptContext context);
 
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
 
 private:
     enum class OpType {
@@ -110,9 +151,27 @@ private:
 
     void startReadInternal(DeviceIdType address, std::size_t length);
     bool cancelReadInternal();
-    void startWriteInternal(DeviceIdType address, std::size_t length);
+    void startWriteInternal(
+        DeviceIdType address,
+        std::size_t length,
+        const CharType* headerBuf = nullptr,
+        std::size_t headerLength = 0);
     bool cancelWriteInternal();
-    void interruptHandler();
+    void startWriteReadInternal(
+        DeviceIdType address,
+        const CharType* writeBuf,
+        std::size_t writeLength,
+        std::size_t readLength);
+    void attach(
+        OpType op,
+        DeviceIdType address,
+        const CharType* buf,
+        std::size_t length);
+    bool takeAttachment(
+        OpType op,
+        DeviceIdType address,
+        const CharType*& buf,
+        std::size_t& length);
     void completeTransfer(const embxx::error::ErrorStatus& status);
     void setAddrAndLen(DeviceIdType address, LengthType length);
 
@@ -123,6 +182,20 @@ private:
     OpType op_;
     std::size_t remainingLen_;
 
+    /// Data written before the payload of the next operation
+    struct Attachment
+    {
+        Attachment() : buf_(nullptr), length_(0), op_(OpType::Idle), address_(0) {}
+
+        const CharType* volatile buf_; // nullptr when slot is free
+        std::size_t length_;
+        OpType op_;
+        DeviceIdType address_;
+    };
+
+    static const std::size_t MaxAttachments = 4;
+    std::array<Attachment, MaxAttachments> attachments_;
+
     typedef Function::PinIdxType PinIdxType;
     typedef Function::FuncSel FuncSel;
 
@@ -149,6 +222,7 @@ private:
 
     static constexpr auto pBSC0_S =
         reinterpret_cast<volatile EntryType*>(0x20205004);
+    static const std::size_t BSC0_S_TransferActivePos = 0;
     static const std::size_t BSC0_S_TransferDonePos = 1;
     static const std::size_t BSC0_S_FifoNeedsWritingPos = 2;
     static const std::size_t BSC0_S_FifoNeedsReadingPos = 3;
@@ -283,6 +357,13 @@ void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
     TContext context)
 {
     static_cast<void>(context);
+    const CharType* writeBuf = nullptr;
+    std::size_t writeLength = 0;
+    if (takeAttachment(OpType::Read, address, writeBuf, writeLength)) {
+        startWriteReadInternal(address, writeBuf, writeLength, length);
+        return;
+    }
+
     startReadInternal(address, length);
 }
 
@@ -297,6 +378,28 @@ bool I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
     return cancelReadInternal();
 }
 
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setWriteBeforeRead(
+    DeviceIdType address,
+    const CharType* buf,
+    std::size_t length)
+{
+    attach(OpType::Read, address, buf, length);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setWriteHeader(
+    DeviceIdType address,
+    const CharType* buf,
+    std::size_t length)
+{
+    attach(OpType::Write, address, buf, length);
+}
+
 template <typename TInterruptMgr,
           typename TCanDoHandler,
           typename TOpCompleteHandler>
@@ -307,7 +410,10 @@ void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
     TContext context)
 {
     static_cast<void>(context);
-    startWriteInternal(address, length);
+    const CharType* headerBuf = nullptr;
+    std::size_t headerLength = 0;
+    takeAttachment(OpType::Write, address, headerBuf, headerLength);
+    startWriteInternal(address, length, headerBuf, headerLength);
 }
 
 template <typename TInterruptMgr,
@@ -480,23 +586,55 @@ template <typename TInterruptMgr,
           typename TOpCompleteHandler>
 void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWriteInternal(
     DeviceIdType address,
-    std::size_t length)
+    std::size_t length,
+    const CharType* headerBuf,
+    std::size_t headerLength)
 {
     GASSERT(op_ == OpType::Idle);
     GASSERT(remainingLen_ == 0);
-    GASSERT(length <= genMask(BSC0_DLEN_DataLengthPos, BSC0_DLEN_DataLengthLen));
+    GASSERT(headerLength <= FifoSize);
+    GASSERT((length + headerLength) <= genMask(BSC0_DLEN_DataLengthPos, BSC0_DLEN_DataLengthLen));
 
     op_ = OpType::Write;
-    setAddrAndLen(address, static_cast<LengthType>(length));
 
-    static const auto StartWriteControl =
+    if (headerLength == 0) {
+        setAddrAndLen(address, static_cast<LengthType>(length));
+
+        static const auto StartWriteControl =
+            genMask(BSC0_C_I2CEnablePos) |
+            genMask(BSC0_C_InterruptOnTxPos) |
+            genMask(BSC0_C_InterruptOnDonePos) |
+            genMask(BSC0_C_StartTransferPos) |
+            genMask(BSC0_C_ClearFifoPos);
+
+        *pBSC0_C = StartWriteControl;
+        return;
+    }
+
+    GASSERT(headerBuf != nullptr);
+    static const auto ClearFifoControl =
+        genMask(BSC0_C_I2CEnablePos) |
+        genMask(BSC0_C_ClearFifoPos);
+
+    *pBSC0_C = ClearFifoControl;
+
+    // Header is pushed into FIFO before the start, the payload is
+    // requested via "can write" notifications as usual.
+    setAddrAndLen(address, static_cast<LengthType>(headerLength + length));
+    for (std::size_t idx = 0; idx < headerLength; ++idx) {
+        *pBSC0_FIFO =
+            static_cast<EntryType>(headerBuf[idx]) &
+            genMask(BSC0_FIFO_DataPos, BSC0_FIFO_DataLen);
+    }
+    remainingLen_ = length;
+
+    static const auto StartWriteNoClearControl =
         genMask(BSC0_C_I2CEnablePos) |
         genMask(BSC0_C_InterruptOnTxPos) |
         genMask(BSC0_C_InterruptOnDonePos) |
-        genMask(BSC0_C_StartTransferPos) |
-        genMask(BSC0_C_ClearFifoPos);
+        genMask(BSC0_C_StartTransferPos);
 
-    *pBSC0_C = StartWriteControl;
+    *pBSC0_C = StartWriteNoClearControl;
 }
 
 template <typename TInterruptMgr,
@@ -527,6 +665,167 @@ bool I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWriteInternal
     return true;
 }
 
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWriteReadInternal(
+    DeviceIdType address,
+    const CharType* writeBuf,
+    std::size_t writeLength,
+    std::size_t readLength)
+{
+    GASSERT(op_ == OpType::Idle);
+    GASSERT(remainingLen_ == 0);
+    GASSERT(writeBuf != nullptr);
+    GASSERT((0 < writeLength) && (writeLength <= FifoSize));
+    GASSERT(readLength <= genMask(BSC0_DLEN_DataLengthPos, BSC0_DLEN_DataLengthLen));
+
+    static const auto ClearFifoControl =
+        genMask(BSC0_C_I2CEnablePos) |
+        genMask(BSC0_C_ClearFifoPos);
+
+    *pBSC0_C = ClearFifoControl;
+    *pBSC0_S = BSC0_S_WritableBits;
+
+    // The whole write phase fits into FIFO, no need for TXW interrupts.
+    setAddrAndLen(address, static_cast<LengthType>(writeLength));
+    for (std::size_t idx = 0; idx < writeLength; ++idx) {
+        *pBSC0_FIFO =
+            static_cast<EntryType>(writeBuf[idx]) &
+            genMask(BSC0_FIFO_DataPos, BSC0_FIFO_DataLen);
+    }
+
+    static const auto StartWritePhaseControl =
+        genMask(BSC0_C_I2CEnablePos) |
+        genMask(BSC0_C_StartTransferPos);
+
+    *pBSC0_C = StartWritePhaseControl;
+
+    // The controller latches new DLEN and READ+ST values while the write
+    // phase is active and issues repeated start (no STOP) when the write
+    // data is exhausted. Wait for the write phase to become active, it
+    // happens within single bit time after the start. Every poll takes at
+    // least one core clock, bound the wait by two bit times (may be invoked
+    // in interrupt context).
+    static const auto ActiveOrDoneMask =
+        genMask(BSC0_S_TransferActivePos) |
+        genMask(BSC0_S_TransferDonePos);
+
+    static const EntryType MaxDivider = 0x8000; // Divider 0 means 32768
+    auto divider = getDivider();
+    if (divider == 0) {
+        divider = MaxDivider;
+    }
+
+    EntryType status = 0;
+    for (EntryType polls = 0; polls < (divider * 2); ++polls) {
+        status = *pBSC0_S;
+        if ((status & ActiveOrDoneMask) != 0) {
+            break;
+        }
+    }
+
+    op_ = OpType::Read;
+    remainingLen_ = readLength;
+
+    if ((status & genMask(BSC0_S_TransferActivePos)) == 0) {
+        // The write phase is already over (e.g. address NAKed by busy
+        // EEPROM) or didn't start, the read phase must not be issued.
+        // The DONE interrupt (possibly already pending) reports the
+        // failure and clears the status.
+        static const auto WaitForWriteFailureControl =
+            genMask(BSC0_C_I2CEnablePos) |
+            genMask(BSC0_C_InterruptOnDonePos);
+
+        *pBSC0_C = WaitForWriteFailureControl;
+        return;
+    }
+
+    *pBSC0_DLEN = static_cast<EntryType>(readLength);
+
+    static const auto StartReadPhaseControl =
+        genMask(BSC0_C_I2CEnablePos) |
+        genMask(BSC0_C_InterruptOnRxPos) |
+        genMask(BSC0_C_InterruptOnDonePos) |
+        genMask(BSC0_C_ReadTransferPos) |
+        genMask(BSC0_C_StartTransferPos);
+
+    *pBSC0_C = StartReadPhaseControl;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+void I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::attach(
+    OpType op,
+    DeviceIdType address,
+    const CharType* buf,
+    std::size_t length)
+{
+    GASSERT((buf == nullptr) || ((0 < length) && (length <= FifoSize)));
+
+    // The slots are consumed by startRead()/startWrite(), which may be
+    // invoked in interrupt context. The slot becomes visible to them only
+    // when buf_ is assigned, after the rest of the fields are updated.
+    Attachment* freeSlot = nullptr;
+    for (auto& slot : attachments_) {
+        if (slot.buf_ == nullptr) {
+            if (freeSlot == nullptr) {
+                freeSlot = &slot;
+            }
+            continue;
+        }
+
+        if ((slot.op_ == op) && (slot.address_ == address)) {
+            slot.buf_ = nullptr;
+            __asm volatile("" : : : "memory");
+            if (freeSlot == nullptr) {
+                freeSlot = &slot;
+            }
+        }
+    }
+
+    if (buf == nullptr) {
+        return;
+    }
+
+    GASSERT(freeSlot != nullptr);
+    if (freeSlot == nullptr) {
+        return;
+    }
+
+    freeSlot->length_ = length;
+    freeSlot->op_ = op;
+    freeSlot->address_ = address;
+    __asm volatile("" : : : "memory");
+    freeSlot->buf_ = buf;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler>
+bool I2C0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::takeAttachment(
+    OpType op,
+    DeviceIdType address,
+    const CharType*& buf,
+    std::size_t& length)
+{
+    for (auto& slot : attachments_) {
+        const CharType* slotBuf = slot.buf_;
+        if ((slotBuf == nullptr) ||
+            (slot.op_ != op) ||
+            (slot.address_ != address)) {
+            continue;
+        }
+
+        buf = slotBuf;
+        length = slot.length_;
+        slot.buf_ = nullptr;
+        return true;
+    }
+    return false;
+}
+
 template <typename TInterruptMgr,
           typename TCanDoHandler,
           typename TOpCompleteHandler>
@@ -0,0 +1,76 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace device
+{
+
+namespace interrupt
+{
+
+typedef std::uint32_t PendingType;
+
+/// @brief Get index of the most significant set bit.
+/// @details Compiles into single "clz" instruction. The mask mustn't be 0.
+inline
+std::size_t msbIdx(PendingType mask)
+{
+    static const std::size_t BitsInEntry =
+        std::numeric_limits<PendingType>::digits;
+    return (BitsInEntry - 1) - static_cast<std::size_t>(__builtin_clz(mask));
+}
+
+/// @brief Invoke the handler for every pending and active source.
+/// @details The bits are scanned from the most significant one. The active
+///          mask is re-read before every invocation, the invoked handler
+///          may deactivate other sources which are pending as well.
+///          Doesn't access any hardware, the interrupt managers provide the
+///          pending register value and mapping of the bit index to the
+///          source identifier.
+/// @param pending Value of the pending register.
+/// @param active Mask of the active (enabled) sources in the same register.
+/// @param bitToId Maps bit index to the source identifier, indexed with
+///        operator[].
+/// @param func Functor invoked with the mapped identifier.
+template <typename TBitToId, typename TFunc>
+void dispatchPending(
+    PendingType pending,
+    const PendingType& active,
+    const TBitToId& bitToId,
+    TFunc&& func)
+{
+    while (true) {
+        pending &= active;
+        if (pending == 0) {
+            break;
+        }
+
+        auto bitIdx = msbIdx(pending);
+        pending &= ~(static_cast<PendingType>(1) << bitIdx);
+        func(bitToId[bitIdx]);
+    }
+}
+
+}  // namespace interrupt
+
+}  // namespace device
+
@@ -0,0 +1,162 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace device
+{
+
+struct InterruptIds
+{
+    enum IrqId {
+        IrqId_Timer,
+        IrqId_AuxInt,
+        IrqId_Gpio1,
+        IrqId_Gpio2,
+        IrqId_Gpio3,
+        IrqId_Gpio4,
+        IrqId_I2C,
+        IrqId_SPI,
+        IrqId_Uart0,
+        IrqId_Dma4,
+        IrqId_Dma5,
+        IrqId_SystemTimer3,
+        IrqId_SystemTimer1,
+        IrqId_NumOfIds // Must be last
+    };
+};
+
+namespace interrupt
+{
+
+typedef std::uint32_t RegEntryType;
+
+enum RegIdx {
+    RegIdx_Basic,
+    RegIdx_1,
+    RegIdx_2,
+    RegIdx_NumOfRegs // Must be last
+};
+
+/// @brief Location of the interrupt source bits in the interrupt
+///        controller registers.
+struct Location
+{
+    RegIdx pendingReg_;
+    RegEntryType pendingMask_;
+    RegIdx enDisReg_;
+    RegEntryType enDisMask_;
+};
+
+/// @brief Map of all the interrupt sources, indexed by InterruptIds::IrqId.
+/// @details Shared by all the interrupt managers. Some of the GPU sources
+///          are reported in the basic pending register only, their enable
+///          bits are in the registers 1/2 (IRQ number - 32).
+constexpr Location Locations[] = {
+    // IrqId_Timer
+    {RegIdx_Basic, 1U << 0, RegIdx_Basic, 1U << 0},
+    // IrqId_AuxInt
+    {RegIdx_1, 1U << 29, RegIdx_1, 1U << 29},
+    // IrqId_Gpio1
+    {RegIdx_2, 1U << (49 - 32), RegIdx_2, 1U << (49 - 32)},
+    // IrqId_Gpio2
+    {RegIdx_2, 1U << (50 - 32), RegIdx_2, 1U << (50 - 32)},
+    // IrqId_Gpio3
+    {RegIdx_2, 1U << (51 - 32), RegIdx_2, 1U << (51 - 32)},
+    // IrqId_Gpio4
+    {RegIdx_2, 1U << (52 - 32), RegIdx_2, 1U << (52 - 32)},
+    // IrqId_I2C
+    {RegIdx_Basic, 1U << 15, RegIdx_2, 1U << (53 - 32)},
+    // IrqId_SPI
+    {RegIdx_Basic, 1U << 16, RegIdx_2, 1U << (54 - 32)},
+    // IrqId_Uart0
+    {RegIdx_Basic, 1U << 19, RegIdx_2, 1U << (57 - 32)},
+    // IrqId_Dma4
+    {RegIdx_1, 1U << (16 + 4), RegIdx_1, 1U << (16 + 4)},
+    // IrqId_Dma5
+    {RegIdx_1, 1U << (16 + 5), RegIdx_1, 1U << (16 + 5)},
+    // IrqId_SystemTimer3
+    {RegIdx_1, 1U << 3, RegIdx_1, 1U << 3},
+    // IrqId_SystemTimer1
+    {RegIdx_1, 1U << 1, RegIdx_1, 1U << 1}
+};
+
+static_assert(
+    (sizeof(Locations) / sizeof(Locations[0])) == InterruptIds::IrqId_NumOfIds,
+    "Locations must be updated");
+
+constexpr Location getLocation(InterruptIds::IrqId id)
+{
+    return Locations[id];
+}
+
+// Bits of the basic pending register indicating pending sources in
+// registers 1/2
+const RegEntryType BasicPending1Mask = 0x00000100;
+const RegEntryType BasicPending2Mask = 0x00000200;
+
+const std::uintptr_t PendingRegAddrs[RegIdx_NumOfRegs] = {
+    0x2000B200,
+    0x2000B204,
+    0x2000B208
+};
+
+const std::uintptr_t EnableRegAddrs[RegIdx_NumOfRegs] = {
+    0x2000B218,
+    0x2000B210,
+    0x2000B214
+};
+
+const std::uintptr_t DisableRegAddrs[RegIdx_NumOfRegs] = {
+    0x2000B224,
+    0x2000B21C,
+    0x2000B220
+};
+
+const std::uintptr_t FiqControlAddr = 0x2000B20C;
+
+inline
+volatile RegEntryType* pendingReg(RegIdx reg)
+{
+    return reinterpret_cast<volatile RegEntryType*>(PendingRegAddrs[reg]);
+}
+
+inline
+volatile RegEntryType* enableReg(RegIdx reg)
+{
+    return reinterpret_cast<volatile RegEntryType*>(EnableRegAddrs[reg]);
+}
+
+inline
+volatile RegEntryType* disableReg(RegIdx reg)
+{
+    return reinterpret_cast<volatile RegEntryType*>(DisableRegAddrs[reg]);
+}
+
+inline
+volatile RegEntryType* fiqControlReg()
+{
+    return reinterpret_cast<volatile RegEntryType*>(FiqControlAddr);
+}
+
+}  // namespace interrupt
+
+}  // namespace device
+
@@ -18,245 +18,780 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include <array>
-#include <algorithm>
+#include <limits>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StaticFunction.h"
 
+#include "InterruptStats.h"
+#include "InterruptBits.h"
+#include "InterruptMap.h"
+
 namespace device
 {
 
 namespace interrupt
 {
 
+// Both IRQ and FIQ are enabled/disabled
 inline
 void enable()
 {
-    __asm volatile("cpsie i");
+    __asm volatile("cpsie if");
 }
 
 inline
 void disable()
 {
-    __asm volatile("cpsid i");
+    __asm volatile("cpsid if");
+}
+
+typedef std::uint32_t Flags;
+
+inline
+Flags save()
+{
+    Flags flags;
+    __asm volatile("mrs %0, cpsr" : "=r" (flags));
+    return flags;
+}
+
+inline
+void restore(Flags flags)
+{
+    __asm volatile("msr cpsr_c, %0" : : "r" (flags));
 }
 
 }  // namespace interrupt
 
-template <typename THandler = embxx::util::StaticFunction<void ()> >
-class InterruptMgr
+/// @brief Interrupt controller manager.
+/// @tparam THandler Type of the interrupt handler functor.
+/// @tparam TCollectStats Record execution statistics of every handler
+///         (see InterruptStats). Adds no code or data when false.
+/// @tparam TPriorityLevels Number of interrupt priority levels. When greater
+///         than 1, the handlers are executed with interrupts enabled and
+///         all the sources of the same or lower priority level masked in
+///         the interrupt controller, i.e. the handler may be pre-empted by
+///         the handler of higher priority source. The duration statistics
+///         of pre-empted handler include the pre-emption time.
+template <typename THandler = embxx::util::StaticFunction<void ()>,
+          bool TCollectStats = false,
+          std::size_t TPriorityLevels = 1>
+class InterruptMgr :
+    public InterruptIds,
+    private InterruptStats<InterruptIds::IrqId_NumOfIds, TCollectStats>
 {
+    typedef InterruptStats<IrqId_NumOfIds, TCollectStats> Stats;
 public:
     typedef THandler HandlerFunc;
-    enum IrqId {
-        IrqId_Timer,
-        IrqId_AuxInt,
-        IrqId_Gpio1,
-        IrqId_Gpio2,
-        IrqId_Gpio3,
-        IrqId_Gpio4,
-        IrqId_I2C,
-        IrqId_SPI,
-        IrqId_NumOfIds // Must be last
-    };
+    typedef typename Stats::TicksType TicksType;
+    typedef typename Stats::Entry StatsEntry;
+    typedef std::size_t PriorityType;
+
+    static const std::size_t NumOfPriorityLevels = TPriorityLevels;
+
+    static_assert(0 < NumOfPriorityLevels,
+        "At least one priority level is required");
 
     InterruptMgr();
 
     template <typename TFunc>
     void registerHandler(IrqId id, TFunc&& handler);
 
+    /// @brief Set priority level of the interrupt source.
+    /// @details 0 is the lowest priority (default for all the sources),
+    ///          (NumOfPriorityLevels - 1) is the highest one. Expected to
+    ///          be called when the source is disabled.
+    void setPriority(IrqId id, PriorityType priority);
+
+    PriorityType getPriority(IrqId id) const;
+
     void enableInterrupt(IrqId id);
 
     void disableInterrupt(IrqId id);
 
     void handleInterrupt();
 
+    /// @brief Route the interrupt source to FIQ.
+    /// @details Only single source can be routed to FIQ at a time. Its
+    ///          registered handler is invoked from handleFastInterrupt()
+    ///          which may be called by the fastInterruptHandler() function.
+    ///          For the lowest latency fastInterruptHandler() should invoke
+    ///          the interrupt handler of the device directly instead,
+    ///          bypassing the type erased handler and the statistics (see
+    ///          app_uart1_comms).
+    ///          Enabling/disabling of the source controls the FIQ enable
+    ///          bit instead of the IRQ enable registers.
+    void routeToFiq(IrqId id);
+
+    /// @brief Route the source previously passed to routeToFiq() back to IRQ.
+    void routeToIrq();
+
+    void handleFastInterrupt();
+
+    /// @brief Include/exclude the source from the set of sources masked
+    ///        by lockSources().
+    /// @details All the sources are lockable by default. The handler of the
+    ///          source which is not lockable mustn't access the data protected
+    ///          by lockSources() (such as event loop queue).
+    void setLockable(IrqId id, bool lockable);
+
+    bool isLockable(IrqId id) const;
+
+    /// @brief Mask all the lockable sources in the interrupt controller.
+    /// @details Used to protect data shared with interrupt handlers without
+    ///          global disabling of the interrupts (see SelectiveInterruptLock).
+    ///          The sources enabled while locked are unmasked by
+    ///          unlockSources(). Non-reentrant.
+    void lockSources();
+
+    void unlockSources();
+
+    /// @brief Get snapshot of the handler statistics.
+    /// @details Available only when TCollectStats is true.
+    StatsEntry getStats(IrqId id) const;
+
+    /// @brief Reset all the handler statistics.
+    /// @details Available only when TCollectStats is true.
+    void resetStats();
+
+    /// @brief Get upper bound of the handler duration percentile.
+    static TicksType getPercentileTicks(
+        const StatsEntry& entry,
+        unsigned percent);
+
+    /// @brief Get average handler duration.
+    static TicksType getAverageTicks(const StatsEntry& entry);
+
+    /// @brief Get frequency of the statistics ticks in Hz.
+    static unsigned getTicksFrequency();
+
 private:
 
     typedef std::uint32_t EntryType;
 
+    typedef interrupt::RegIdx IrqReg;
+
     struct IrqInfo {
         IrqInfo();
 
         HandlerFunc handler_;
-        volatile EntryType* pendingPtr_;
+        IrqReg pendingReg_;
         EntryType pendingMask_;
-        volatile EntryType* enablePtr_;
-        volatile EntryType* disablePtr_;
+        IrqReg enDisReg_;
         EntryType enDisMask_;
+        PriorityType priority_;
+        bool lockable_;
     };
 
-    typedef std::array<IrqInfo, IrqId_NumOfIds> IrqsArray;
-
-    IrqsArray irqs_;
-
-    static constexpr volatile EntryType* IrqBasicPending =
-        reinterpret_cast<EntryType*>(0x2000B200);
-
-    static constexpr volatile EntryType* IrqPending1 =
-        reinterpret_cast<EntryType*>(0x2000B204);
+    struct FlatTag {};
+    struct NestedTag {};
+    typedef typename std::conditional<
+        (1 < NumOfPriorityLevels),
+        NestedTag,
+        FlatTag
+    >::type DispatchTag;
 
-    static constexpr volatile EntryType* IrqPending2 =
-        reinterpret_cast<EntryType*>(0x2000B208);
+    static const std::size_t BitsInEntry =
+        std::numeric_limits<EntryType>::digits;
 
-    static constexpr volatile EntryType* IrqEnableBasic =
-        reinterpret_cast<EntryType*>(0x2000B218);
+    typedef std::array<IrqInfo, IrqId_NumOfIds> IrqsArray;
+    typedef std::uint8_t IrqIdxType;
+    typedef std::array<IrqIdxType, BitsInEntry> BitToIrqMap;
+    typedef std::array<BitToIrqMap, interrupt::RegIdx_NumOfRegs> BitToIrqMaps;
+    typedef std::array<EntryType, interrupt::RegIdx_NumOfRegs> RegMasks;
+    typedef std::array<RegMasks, NumOfPriorityLevels> LevelMasks;
+    typedef std::array<RegMasks, NumOfPriorityLevels + 1> RunLevelMasks;
+
+    static_assert(IrqId_NumOfIds < std::numeric_limits<IrqIdxType>::max(),
+        "IrqIdxType is too small");
+
+    void handleInterruptInternal(FlatTag);
+    void handleInterruptInternal(NestedTag);
+    void dispatchPending(IrqReg reg, EntryType pending);
+    void dispatchPendingNested(IrqReg reg, EntryType pending);
+    void invokeHandler(std::size_t id);
+    void invokeHandlerNested(std::size_t id);
+    void updateMasks(const IrqInfo& info, bool enabled);
+    void updateFiqEnabled(bool enabled);
+    void updatePriorityMasks();
+    void updateLockableMasks();
+    EntryType getMaskedEnDis(IrqReg reg) const;
+    bool isFiqMasked() const;
+    void maskRunLevels(std::size_t fromRunLevel, std::size_t toRunLevel);
+    void unmaskRunLevels(std::size_t fromRunLevel, std::size_t toRunLevel);
 
-    static constexpr volatile EntryType* IrqEnable1 =
-        reinterpret_cast<EntryType*>(0x2000B210);
+    IrqsArray irqs_;
+    BitToIrqMaps bitToIrq_;
+    RegMasks activeMasks_;
+    RegMasks enabledMasks_;
 
-    static constexpr volatile EntryType* IrqEnable2 =
-        reinterpret_cast<EntryType*>(0x2000B214);
+    // Pending bits of the sources, that have exactly the specified priority
+    LevelMasks levelPendingMasks_;
 
-    static constexpr volatile EntryType* IrqDisableBasic =
-        reinterpret_cast<EntryType*>(0x2000B224);
+    // Enable bits of the sources, masked when the handler of the
+    // (run level - 1) priority is executed. Run level 0 means no handler
+    // is running.
+    RunLevelMasks runLevelEnDisMasks_;
+    std::size_t runLevel_;
 
-    static constexpr volatile EntryType* IrqDisable1 =
-        reinterpret_cast<EntryType*>(0x2000B21C);
+    std::size_t fiqId_;
+    bool fiqEnabled_;
 
-    static constexpr volatile EntryType* IrqDisable2 =
-        reinterpret_cast<EntryType*>(0x2000B220);
+    // Enable bits of the sources masked by lockSources()
+    RegMasks lockableEnDisMasks_;
+    bool sourcesLocked_;
 
-    static const EntryType MaskPending1 = 0x00000100;
-    static const EntryType MaskPending2 = 0x00000200;
+    static const EntryType FiqSourceBasicOffset = 64;
+    static const EntryType FiqSource2Offset = 32;
+    static const std::size_t FiqEnablePos = 7;
+    static const EntryType FiqEnableMask =
+        static_cast<EntryType>(1) << FiqEnablePos;
 
 };
 
 // Implementation
 
-template <typename THandler>
-InterruptMgr<THandler>::InterruptMgr()
-{
-    {
-        auto& timerIrq = irqs_[IrqId_Timer];
-        timerIrq.pendingPtr_ = IrqBasicPending;
-        timerIrq.pendingMask_ = static_cast<EntryType>(1) << 0;
-        timerIrq.enablePtr_ = IrqEnableBasic;
-        timerIrq.disablePtr_ = IrqDisableBasic;
-        timerIrq.enDisMask_ = timerIrq.pendingMask_;
-        static_cast<void>(timerIrq);
-    }
-
-    {
-        auto& auxIrq = irqs_[IrqId_AuxInt];
-        auxIrq.pendingPtr_ = IrqPending1;
-        auxIrq.pendingMask_ = static_cast<EntryType>(1) << 29;
-        auxIrq.enablePtr_ = IrqEnable1;
-        auxIrq.disablePtr_ = IrqDisable1;
-        auxIrq.enDisMask_ = auxIrq.pendingMask_;
-        static_cast<void>(auxIrq);
-    }
-
-    for (int i = 0; i <= (IrqId_Gpio4 - IrqId_Gpio1); ++i) {
-        auto& gpioIrq = irqs_[IrqId_Gpio1 + i];
-        gpioIrq.pendingPtr_ = IrqPending2;
-        gpioIrq.pendingMask_ = static_cast<EntryType>(1) << ((49 - 32) + i);
-        gpioIrq.enablePtr_ = IrqEnable2;
-        gpioIrq.disablePtr_ = IrqDisable2;
-        gpioIrq.enDisMask_ = gpioIrq.pendingMask_;
-        static_cast<void>(gpioIrq);
-    }
-
-    {
-        auto& i2cIrq = irqs_[IrqId_I2C];
-        i2cIrq.pendingPtr_ = IrqBasicPending;
-        i2cIrq.pendingMask_ = static_cast<EntryType>(1) << 15;
-        i2cIrq.enablePtr_ = IrqEnable2;
-        i2cIrq.disablePtr_ = IrqDisable2;
-        i2cIrq.enDisMask_ = static_cast<EntryType>(1) << (53 - 32);
-        static_cast<void>(i2cIrq);
-    }
-
-    {
-        auto& spiIrq = irqs_[IrqId_SPI];
-        spiIrq.pendingPtr_ = IrqBasicPending;
-        spiIrq.pendingMask_ = static_cast<EntryType>(1) << 16;
-        spiIrq.enablePtr_ = IrqEnable2;
-        spiIrq.disablePtr_ = IrqDisable2;
-        spiIrq.enDisMask_ = static_cast<EntryType>(1) << (54 - 32);
-        static_cast<void>(spiIrq);
-    }
-}
-
-template <typename THandler>
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::InterruptMgr()
+    : runLevel_(0),
+      fiqId_(IrqId_NumOfIds),
+      fiqEnabled_(false),
+      sourcesLocked_(false)
+{
+    for (auto& bitToIrq : bitToIrq_) {
+        bitToIrq.fill(static_cast<IrqIdxType>(IrqId_NumOfIds));
+    }
+    activeMasks_.fill(0);
+    enabledMasks_.fill(0);
+
+    for (auto idx = 0U; idx < IrqId_NumOfIds; ++idx) {
+        auto location = interrupt::getLocation(static_cast<IrqId>(idx));
+        auto& info = irqs_[idx];
+        info.pendingReg_ = location.pendingReg_;
+        info.pendingMask_ = location.pendingMask_;
+        info.enDisReg_ = location.enDisReg_;
+        info.enDisMask_ = location.enDisMask_;
+    }
+
+    updatePriorityMasks();
+    updateLockableMasks();
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
 template <typename TFunc>
-void InterruptMgr<THandler>::registerHandler(
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::registerHandler(
     IrqId id,
     TFunc&& handler)
 {
     GASSERT(id < IrqId_NumOfIds);
-    irqs_[id].handler_ = std::forward<TFunc>(handler);
+    auto& info = irqs_[id];
+    info.handler_ = std::forward<TFunc>(handler);
+    auto bitIdx = interrupt::msbIdx(info.pendingMask_);
+    bitToIrq_[info.pendingReg_][bitIdx] = static_cast<IrqIdxType>(id);
 }
 
-template <typename THandler>
-void InterruptMgr<THandler>::enableInterrupt(IrqId id)
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::setPriority(
+    IrqId id,
+    PriorityType priority)
 {
     GASSERT(id < IrqId_NumOfIds);
-    auto& info = irqs_[id];
-    *info.enablePtr_ = info.enDisMask_;
+    GASSERT(priority < NumOfPriorityLevels);
+    auto flags = interrupt::save();
+    interrupt::disable();
+    irqs_[id].priority_ = priority;
+    updatePriorityMasks();
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+typename InterruptMgr<THandler, TCollectStats, TPriorityLevels>::PriorityType
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getPriority(
+    IrqId id) const
+{
+    GASSERT(id < IrqId_NumOfIds);
+    return irqs_[id].priority_;
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::enableInterrupt(
+    IrqId id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    if (id == fiqId_) {
+        updateFiqEnabled(true);
+        return;
+    }
+
+    updateMasks(irqs_[id], true);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::disableInterrupt(
+    IrqId id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    if (id == fiqId_) {
+        updateFiqEnabled(false);
+        return;
+    }
+
+    updateMasks(irqs_[id], false);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::handleInterrupt()
+{
+    handleInterruptInternal(DispatchTag());
 }
 
-template <typename THandler>
-void InterruptMgr<THandler>::disableInterrupt(IrqId id)
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::routeToFiq(
+    IrqId id)
 {
     GASSERT(id < IrqId_NumOfIds);
+    GASSERT(fiqId_ == IrqId_NumOfIds); // Only single FIQ source is supported
     auto& info = irqs_[id];
-    *info.disablePtr_ = info.enDisMask_;
+
+    EntryType source = interrupt::msbIdx(info.enDisMask_);
+    if (info.enDisReg_ == interrupt::RegIdx_Basic) {
+        source += FiqSourceBasicOffset;
+    }
+    else if (info.enDisReg_ == interrupt::RegIdx_2) {
+        source += FiqSource2Offset;
+    }
+
+    auto flags = interrupt::save();
+    interrupt::disable();
+    bool enabled = ((enabledMasks_[info.enDisReg_] & info.enDisMask_) != 0);
+    if (enabled) {
+        updateMasks(info, false);
+    }
+
+    fiqId_ = id;
+    fiqEnabled_ = enabled;
+    if (enabled && (!isFiqMasked())) {
+        source |= FiqEnableMask;
+    }
+    *interrupt::fiqControlReg() = source;
+    interrupt::restore(flags);
 }
 
-template <typename THandler>
-void InterruptMgr<THandler>::handleInterrupt()
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::routeToIrq()
 {
-    auto irqsBasic = *IrqBasicPending;
-    auto irqsPending1 = *IrqPending1;
-    auto irqsPending2 = *IrqPending2;
+    auto flags = interrupt::save();
+    interrupt::disable();
+    if (fiqId_ < IrqId_NumOfIds) {
+        bool enabled = fiqEnabled_;
+        *interrupt::fiqControlReg() = 0;
+        auto& info = irqs_[fiqId_];
+        fiqId_ = IrqId_NumOfIds;
+        fiqEnabled_ = false;
+        if (enabled) {
+            updateMasks(info, true);
+        }
+    }
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::handleFastInterrupt()
+{
+    // No demultiplexing, there is single FIQ source
+    invokeHandler(fiqId_);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::setLockable(
+    IrqId id,
+    bool lockable)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    GASSERT(!sourcesLocked_);
+    auto flags = interrupt::save();
+    interrupt::disable();
+    irqs_[id].lockable_ = lockable;
+    updateLockableMasks();
+    interrupt::restore(flags);
+}
 
-    std::for_each(irqs_.begin(), irqs_.end(),
-        [this, irqsBasic, irqsPending1, irqsPending2](IrqInfo& info)
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+bool InterruptMgr<THandler, TCollectStats, TPriorityLevels>::isLockable(
+    IrqId id) const
+{
+    GASSERT(id < IrqId_NumOfIds);
+    return irqs_[id].lockable_;
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::lockSources()
+{
+    // Interrupts are disabled only for the update of the masks,
+    // not for the whole duration of the lock.
+    auto flags = interrupt::save();
+    interrupt::disable();
+    GASSERT(!sourcesLocked_);
+    for (auto reg = 0U; reg < interrupt::RegIdx_NumOfRegs; ++reg) {
+        auto ireg = static_cast<IrqReg>(reg);
+        auto mask =
+            enabledMasks_[reg] & lockableEnDisMasks_[reg] & (~getMaskedEnDis(ireg));
+        if (mask != 0) {
+            *interrupt::disableReg(ireg) = mask;
+        }
+    }
+    sourcesLocked_ = true;
+
+    if (fiqEnabled_ && isFiqMasked()) {
+        *interrupt::fiqControlReg() &= ~FiqEnableMask;
+    }
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::unlockSources()
+{
+    auto flags = interrupt::save();
+    interrupt::disable();
+    GASSERT(sourcesLocked_);
+    bool fiqMasked = isFiqMasked();
+    sourcesLocked_ = false;
+    for (auto reg = 0U; reg < interrupt::RegIdx_NumOfRegs; ++reg) {
+        auto ireg = static_cast<IrqReg>(reg);
+        auto mask =
+            enabledMasks_[reg] & lockableEnDisMasks_[reg] & (~getMaskedEnDis(ireg));
+        if (mask != 0) {
+            *interrupt::enableReg(ireg) = mask;
+        }
+    }
+
+    if (fiqEnabled_ && fiqMasked) {
+        *interrupt::fiqControlReg() |= FiqEnableMask;
+    }
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+typename InterruptMgr<THandler, TCollectStats, TPriorityLevels>::StatsEntry
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getStats(
+    IrqId id) const
+{
+    static_assert(TCollectStats, "Statistics collection is disabled");
+    auto flags = interrupt::save();
+    interrupt::disable();
+    StatsEntry entry = Stats::getEntry(id);
+    interrupt::restore(flags);
+    return entry;
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::resetStats()
+{
+    static_assert(TCollectStats, "Statistics collection is disabled");
+    auto flags = interrupt::save();
+    interrupt::disable();
+    Stats::reset();
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+typename InterruptMgr<THandler, TCollectStats, TPriorityLevels>::TicksType
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getPercentileTicks(
+    const StatsEntry& entry,
+    unsigned percent)
+{
+    return Stats::getPercentileTicks(entry, percent);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+typename InterruptMgr<THandler, TCollectStats, TPriorityLevels>::TicksType
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getAverageTicks(
+    const StatsEntry& entry)
+{
+    return Stats::getAverageTicks(entry);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+unsigned InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getTicksFrequency()
+{
+    return Stats::getTicksFrequency();
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::handleInterruptInternal(
+    FlatTag)
+{
+    auto irqsBasic = *interrupt::pendingReg(interrupt::RegIdx_Basic);
+    dispatchPending(interrupt::RegIdx_Basic, irqsBasic);
+
+    if ((irqsBasic & interrupt::BasicPending1Mask) != 0) {
+        dispatchPending(
+            interrupt::RegIdx_1,
+            *interrupt::pendingReg(interrupt::RegIdx_1));
+    }
+
+    if ((irqsBasic & interrupt::BasicPending2Mask) != 0) {
+        dispatchPending(
+            interrupt::RegIdx_2,
+            *interrupt::pendingReg(interrupt::RegIdx_2));
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::handleInterruptInternal(
+    NestedTag)
+{
+    RegMasks pending;
+    pending[interrupt::RegIdx_Basic] =
+        *interrupt::pendingReg(interrupt::RegIdx_Basic);
+    pending[interrupt::RegIdx_1] = 0;
+    pending[interrupt::RegIdx_2] = 0;
+
+    if ((pending[interrupt::RegIdx_Basic] & interrupt::BasicPending1Mask) != 0) {
+        pending[interrupt::RegIdx_1] =
+            *interrupt::pendingReg(interrupt::RegIdx_1);
+    }
+
+    if ((pending[interrupt::RegIdx_Basic] & interrupt::BasicPending2Mask) != 0) {
+        pending[interrupt::RegIdx_2] =
+            *interrupt::pendingReg(interrupt::RegIdx_2);
+    }
+
+    // Sources of the same or lower priority than the interrupted handler
+    // are masked, only higher levels are considered.
+    auto level = NumOfPriorityLevels;
+    while (runLevel_ < level) {
+        --level;
+        auto& levelMasks = levelPendingMasks_[level];
+        for (auto reg = 0U; reg < interrupt::RegIdx_NumOfRegs; ++reg) {
+            dispatchPendingNested(
+                static_cast<IrqReg>(reg),
+                pending[reg] & levelMasks[reg]);
+        }
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::dispatchPending(
+    IrqReg reg,
+    EntryType pending)
+{
+    interrupt::dispatchPending(
+        pending,
+        activeMasks_[reg],
+        bitToIrq_[reg],
+        [this](std::size_t id)
         {
-            bool invoke = false;
-            do {
-                if (info.pendingPtr_ == IrqBasicPending) {
-                    if ((info.pendingMask_ & irqsBasic) != 0) {
-                        invoke = true;
-                    }
-                    break;
-                }
-
-                if (info.pendingPtr_ == IrqPending1) {
-                    if (((irqsBasic & MaskPending1) != 0) &&
-                        ((info.pendingMask_ & irqsPending1) != 0)) {
-                        invoke = true;
-                    }
-                    break;
-                }
-
-                if (info.pendingPtr_ == IrqPending2) {
-                    if (((irqsBasic & MaskPending2) != 0) &&
-                        ((info.pendingMask_ & irqsPending2) != 0)) {
-                        invoke = true;
-                    }
-                    break;
-                }
-            } while (false);
-
-            if (invoke) {
-                if (info.handler_) {
-                    info.handler_();
-                }
-            }
+            invokeHandler(id);
         });
 }
 
-template <typename THandler>
-InterruptMgr<THandler>::IrqInfo::IrqInfo()
-    : pendingPtr_(0),
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::dispatchPendingNested(
+    IrqReg reg,
+    EntryType pending)
+{
+    // The handler of higher priority may disable the source
+    interrupt::dispatchPending(
+        pending,
+        activeMasks_[reg],
+        bitToIrq_[reg],
+        [this](std::size_t id)
+        {
+            invokeHandlerNested(id);
+        });
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::invokeHandler(
+    std::size_t id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    if (IrqId_NumOfIds <= id) {
+        return;
+    }
+
+    auto& info = irqs_[id];
+    if (info.handler_) {
+        auto startTicks = Stats::start();
+        info.handler_();
+        Stats::record(id, startTicks);
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::invokeHandlerNested(
+    std::size_t id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    if (IrqId_NumOfIds <= id) {
+        return;
+    }
+
+    auto prevRunLevel = runLevel_;
+    auto nextRunLevel = irqs_[id].priority_ + 1;
+    GASSERT(prevRunLevel < nextRunLevel);
+
+    maskRunLevels(prevRunLevel, nextRunLevel);
+    runLevel_ = nextRunLevel;
+    interrupt::enable();
+
+    invokeHandler(id);
+
+    interrupt::disable();
+    runLevel_ = prevRunLevel;
+    unmaskRunLevels(nextRunLevel, prevRunLevel);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::updateMasks(
+    const IrqInfo& info,
+    bool enabled)
+{
+    // May be invoked from both event loop and interrupt contexts
+    auto flags = interrupt::save();
+    interrupt::disable();
+    auto& activeMask = activeMasks_[info.pendingReg_];
+    auto& enabledMask = enabledMasks_[info.enDisReg_];
+    if (enabled) {
+        activeMask |= info.pendingMask_;
+        enabledMask |= info.enDisMask_;
+        // Sources masked by the running handler or lockSources() are
+        // enabled upon handler exit or unlockSources()
+        if ((getMaskedEnDis(info.enDisReg_) & info.enDisMask_) == 0) {
+            *interrupt::enableReg(info.enDisReg_) = info.enDisMask_;
+        }
+    }
+    else {
+        *interrupt::disableReg(info.enDisReg_) = info.enDisMask_;
+        activeMask &= ~info.pendingMask_;
+        enabledMask &= ~info.enDisMask_;
+    }
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::updateFiqEnabled(
+    bool enabled)
+{
+    // May be invoked from both event loop and interrupt contexts
+    auto flags = interrupt::save();
+    interrupt::disable();
+    fiqEnabled_ = enabled;
+    auto value = *interrupt::fiqControlReg();
+    if (enabled && (!isFiqMasked())) {
+        value |= FiqEnableMask;
+    }
+    else {
+        value &= ~FiqEnableMask;
+    }
+    *interrupt::fiqControlReg() = value;
+    interrupt::restore(flags);
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::updatePriorityMasks()
+{
+    for (auto& levelMasks : levelPendingMasks_) {
+        levelMasks.fill(0);
+    }
+
+    for (auto& runLevelMasks : runLevelEnDisMasks_) {
+        runLevelMasks.fill(0);
+    }
+
+    for (auto& info : irqs_) {
+        GASSERT(info.priority_ < NumOfPriorityLevels);
+        levelPendingMasks_[info.priority_][info.pendingReg_] |=
+            info.pendingMask_;
+
+        for (auto runLevel = info.priority_ + 1;
+             runLevel < runLevelEnDisMasks_.size();
+             ++runLevel) {
+            runLevelEnDisMasks_[runLevel][info.enDisReg_] |= info.enDisMask_;
+        }
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::updateLockableMasks()
+{
+    lockableEnDisMasks_.fill(0);
+    for (auto& info : irqs_) {
+        if (info.lockable_) {
+            lockableEnDisMasks_[info.enDisReg_] |= info.enDisMask_;
+        }
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+typename InterruptMgr<THandler, TCollectStats, TPriorityLevels>::EntryType
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::getMaskedEnDis(
+    IrqReg reg) const
+{
+    auto mask = runLevelEnDisMasks_[runLevel_][reg];
+    if (sourcesLocked_) {
+        mask |= lockableEnDisMasks_[reg];
+    }
+    return mask;
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+bool InterruptMgr<THandler, TCollectStats, TPriorityLevels>::isFiqMasked() const
+{
+    return
+        sourcesLocked_ &&
+        (fiqId_ < IrqId_NumOfIds) &&
+        irqs_[fiqId_].lockable_;
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::maskRunLevels(
+    std::size_t fromRunLevel,
+    std::size_t toRunLevel)
+{
+    auto& fromMasks = runLevelEnDisMasks_[fromRunLevel];
+    auto& toMasks = runLevelEnDisMasks_[toRunLevel];
+    for (auto reg = 0U; reg < interrupt::RegIdx_NumOfRegs; ++reg) {
+        auto mask = enabledMasks_[reg] & toMasks[reg] & (~fromMasks[reg]);
+        if (mask != 0) {
+            *interrupt::disableReg(static_cast<IrqReg>(reg)) = mask;
+        }
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+void InterruptMgr<THandler, TCollectStats, TPriorityLevels>::unmaskRunLevels(
+    std::size_t fromRunLevel,
+    std::size_t toRunLevel)
+{
+    auto& fromMasks = runLevelEnDisMasks_[fromRunLevel];
+    auto& toMasks = runLevelEnDisMasks_[toRunLevel];
+    for (auto reg = 0U; reg < interrupt::RegIdx_NumOfRegs; ++reg) {
+        // Sources disabled by the handler stay disabled, the ones masked
+        // by lockSources() are unmasked by unlockSources()
+        auto mask = enabledMasks_[reg] & fromMasks[reg] & (~toMasks[reg]);
+        if (sourcesLocked_) {
+            mask &= ~lockableEnDisMasks_[reg];
+        }
+        if (mask != 0) {
+            *interrupt::enableReg(static_cast<IrqReg>(reg)) = mask;
+        }
+    }
+}
+
+template <typename THandler, bool TCollectStats, std::size_t TPriorityLevels>
+InterruptMgr<THandler, TCollectStats, TPriorityLevels>::IrqInfo::IrqInfo()
+    : pendingReg_(interrupt::RegIdx_NumOfRegs),
       pendingMask_(0),
-      enablePtr_(0),
-      disablePtr_(0),
-      enDisMask_(0)
+      enDisReg_(interrupt::RegIdx_NumOfRegs),
+      enDisMask_(0),
+      priority_(0),
+      lockable_(true)
 {
 }
 
@@ -0,0 +1,243 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <limits>
+
+#include "embxx/util/Assert.h"
+
+#include "FreeRunningCounter.h"
+
+namespace device
+{
+
+/// @brief Interrupt handlers instrumentation policy.
+/// @details Records invocation count and execution time of every interrupt
+///          handler. The time is measured in ticks of the FreeRunningCounter
+///          at the rate configured by the application (see
+///          getTicksFrequency()).
+/// @tparam TNumOfIds Number of interrupt IDs.
+/// @tparam TEnabled Enable/disable recording. When disabled, the class is
+///         empty and all its functions are no-ops.
+template <std::size_t TNumOfIds, bool TEnabled>
+class InterruptStats;
+
+template <std::size_t TNumOfIds>
+class InterruptStats<TNumOfIds, false>
+{
+public:
+    typedef FreeRunningCounter::TicksType TicksType;
+    struct Entry {};
+
+    TicksType start() const
+    {
+        return 0;
+    }
+
+    static unsigned getTicksFrequency()
+    {
+        return FreeRunningCounter::getFrequency();
+    }
+
+    void record(std::size_t id, TicksType startTicks)
+    {
+        static_cast<void>(id);
+        static_cast<void>(startTicks);
+    }
+};
+
+template <std::size_t TNumOfIds>
+class InterruptStats<TNumOfIds, true>
+{
+public:
+    typedef FreeRunningCounter::TicksType TicksType;
+
+    /// @brief Number of logarithmic histogram buckets.
+    /// @details Bucket "n" accumulates durations in range [2^n, 2^(n+1)).
+    static const std::size_t NumOfBuckets =
+        std::numeric_limits<TicksType>::digits;
+
+    struct Entry
+    {
+        std::uint32_t count_;
+        std::uint64_t totalTicks_;
+        TicksType minTicks_;
+        TicksType maxTicks_;
+        std::array<std::uint32_t, NumOfBuckets> buckets_;
+    };
+
+    InterruptStats();
+
+    TicksType start() const;
+    void record(std::size_t id, TicksType startTicks);
+
+    /// @brief Access statistics of single interrupt.
+    /// @details The entry is updated in interrupt context, the caller is
+    ///          responsible to mask interrupts when copying it.
+    const Entry& getEntry(std::size_t id) const;
+
+    void reset();
+
+    /// @brief Get upper bound of the handler duration percentile.
+    /// @param entry Statistics snapshot.
+    /// @param percent Percentile value in range [0, 100].
+    static TicksType getPercentileTicks(const Entry& entry, unsigned percent);
+
+    static TicksType getAverageTicks(const Entry& entry);
+
+    /// @brief Get frequency of the ticks in Hz.
+    static unsigned getTicksFrequency();
+
+private:
+    typedef std::array<Entry, TNumOfIds> Entries;
+
+    static void resetEntry(Entry& entry);
+    static std::size_t ticksToBucketIdx(TicksType ticks);
+
+    Entries entries_;
+};
+
+// Implementation
+
+template <std::size_t TNumOfIds>
+InterruptStats<TNumOfIds, true>::InterruptStats()
+{
+    if (!FreeRunningCounter::isEnabled()) {
+        FreeRunningCounter::enable();
+    }
+
+    for (auto& entry : entries_) {
+        resetEntry(entry);
+    }
+}
+
+template <std::size_t TNumOfIds>
+unsigned InterruptStats<TNumOfIds, true>::getTicksFrequency()
+{
+    return FreeRunningCounter::getFrequency();
+}
+
+template <std::size_t TNumOfIds>
+typename InterruptStats<TNumOfIds, true>::TicksType
+InterruptStats<TNumOfIds, true>::start() const
+{
+    return FreeRunningCounter::ticks();
+}
+
+template <std::size_t TNumOfIds>
+void InterruptStats<TNumOfIds, true>::record(
+    std::size_t id,
+    TicksType startTicks)
+{
+    auto duration = FreeRunningCounter::ticks() - startTicks;
+    GASSERT(id < TNumOfIds);
+    auto& entry = entries_[id];
+    ++entry.count_;
+    entry.totalTicks_ += duration;
+    if (duration < entry.minTicks_) {
+        entry.minTicks_ = duration;
+    }
+
+    if (entry.maxTicks_ < duration) {
+        entry.maxTicks_ = duration;
+    }
+
+    ++entry.buckets_[ticksToBucketIdx(duration)];
+}
+
+template <std::size_t TNumOfIds>
+const typename InterruptStats<TNumOfIds, true>::Entry&
+InterruptStats<TNumOfIds, true>::getEntry(std::size_t id) const
+{
+    GASSERT(id < TNumOfIds);
+    return entries_[id];
+}
+
+template <std::size_t TNumOfIds>
+void InterruptStats<TNumOfIds, true>::reset()
+{
+    for (auto& entry : entries_) {
+        resetEntry(entry);
+    }
+}
+
+template <std::size_t TNumOfIds>
+typename InterruptStats<TNumOfIds, true>::TicksType
+InterruptStats<TNumOfIds, true>::getPercentileTicks(
+    const Entry& entry,
+    unsigned percent)
+{
+    GASSERT(percent <= 100);
+    if (entry.count_ == 0) {
+        return 0;
+    }
+
+    auto threshold =
+        ((static_cast<std::uint64_t>(entry.count_) * percent) + 99) / 100;
+    std::uint64_t accCount = 0;
+    for (std::size_t idx = 0; idx < entry.buckets_.size(); ++idx) {
+        accCount += entry.buckets_[idx];
+        if (threshold <= accCount) {
+            auto upperBound = (static_cast<std::uint64_t>(1) << (idx + 1)) - 1;
+            if (entry.maxTicks_ < upperBound) {
+                return entry.maxTicks_;
+            }
+            return static_cast<TicksType>(upperBound);
+        }
+    }
+
+    return entry.maxTicks_;
+}
+
+template <std::size_t TNumOfIds>
+typename InterruptStats<TNumOfIds, true>::TicksType
+InterruptStats<TNumOfIds, true>::getAverageTicks(const Entry& entry)
+{
+    if (entry.count_ == 0) {
+        return 0;
+    }
+
+    return static_cast<TicksType>(entry.totalTicks_ / entry.count_);
+}
+
+template <std::size_t TNumOfIds>
+void InterruptStats<TNumOfIds, true>::resetEntry(Entry& entry)
+{
+    entry.count_ = 0;
+    entry.totalTicks_ = 0;
+    entry.minTicks_ = std::numeric_limits<TicksType>::max();
+    entry.maxTicks_ = 0;
+    entry.buckets_.fill(0);
+}
+
+template <std::size_t TNumOfIds>
+std::size_t InterruptStats<TNumOfIds, true>::ticksToBucketIdx(TicksType ticks)
+{
+    if (ticks == 0) {
+        return 0;
+    }
+
+    return
+        (std::numeric_limits<TicksType>::digits - 1) -
+            static_cast<std::size_t>(__builtin_clz(ticks));
+}
+
+}  // namespace device
@@ -19,9 +19,11 @@
 #pragma once
 
 
+#include <cstddef>
 #include <cstdint>
 #include <algorithm>
 #include <limits>
+#include <array>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StaticFunction.h"
@@ -30,13 +32,25 @@
 #include "embxx/device/context.h"
 
 #include "Function.h"
+#include "InterruptMgr.h"
 
 namespace device
 {
 
+/// @brief SPI0 master device.
+/// @details Implements read/write interface to be used with
+///          embxx::device::IdDeviceCharAdapter. Long transfers may be
+///          performed using DMA (see startDmaTransfer()), the completion
+///          of such transfer is reported with single interrupt.
+/// @tparam TInterruptMgr Interrupt manager.
+/// @tparam TCanDoHandler Type of the "can read"/"can write" callbacks.
+/// @tparam TOpCompleteHandler Type of the operation completion callbacks.
+/// @tparam TDmaChannel Type of DMA channel (see DmaChannel) used for the
+///         DMA transfers. When std::nullptr_t, the DMA is not supported.
 template <typename TInterruptMgr,
           typename TCanDoHandler = embxx::util::StaticFunction<void ()>,
-          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)> >
+          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)>,
+          typename TDmaChannel = std::nullptr_t>
 class Spi0
 {
 public:
@@ -51,8 +65,29 @@ public:
     typedef TCanDoHandler CanWriteHandler;
     typedef TOpCompleteHandler ReadCompleteHandler;
     typedef TOpCompleteHandler WriteCompleteHandler;
+    typedef TOpCompleteHandler TransferCompleteHandler;
+    typedef TDmaChannel DmaChannel;
     typedef std::uint32_t EntryType;
 
+    /// @brief Four characters are packed in every word transferred by DMA,
+    ///        the first one in the least significant byte.
+    typedef std::uint32_t DmaWordType;
+
+    /// @brief Single phase of the transaction (see startTransaction()).
+    /// @details When txBuf_ is nullptr, the fill character is transmitted,
+    ///          when rxBuf_ is nullptr, the received data is discarded.
+    struct TransferPhase
+    {
+        const CharType* txBuf_;
+        CharType* rxBuf_;
+        std::size_t length_;
+    };
+
+    static const std::size_t MaxTransactionPhases = 4;
+
+    /// @brief Maximal number of words in single DMA transfer.
+    static const std::size_t MaxDmaWordsCount = 0xffff / sizeof(DmaWordType);
+
     typedef embxx::device::context::EventLoop EventLoopContext;
     typedef embxx::device::context::Interrupt InterruptContext;
 
@@ -65,7 +100,18 @@ public:
         NumOfModes
     };
 
-    Spi0(InterruptMgr& interruptMgr, Function& funcDev, Mode mode = Mode0);
+    /// @brief Constructor
+    /// @param interruptMgr Interrupt manager.
+    /// @param funcDev Pins function configuration device.
+    /// @param mode SPI mode.
+    /// @param txDma DMA channel for transmission, may be nullptr.
+    /// @param rxDma DMA channel for reception, may be nullptr.
+    Spi0(
+        InterruptMgr& interruptMgr,
+        Function& funcDev,
+        Mode mode = Mode0,
+        DmaChannel* txDma = nullptr,
+        DmaChannel* rxDma = nullptr);
 
     static unsigned getFreq(unsigned sysFreq);
     static void setFreq(unsigned sysFreq, unsigned bufFreq);
@@ -122,6 +168,113 @@ public:
     CharType read(InterruptContext context);
     void write(CharType value, InterruptContext context);
 
+    template <typename TFunc>
+    void setTransferCompleteHandler(TFunc&& func);
+
+    /// @brief Start full duplex transfer.
+    /// @details Every transmitted character is taken from txBuf and every
+    ///          received one is stored in rxBuf in the same pass, both
+    ///          directly from the interrupt handler. The completion is
+    ///          reported from the interrupt context using handler set by
+    ///          setTransferCompleteHandler(), the buffers must stay valid
+    ///          until then. Mustn't be used while character read/write or
+    ///          other transfer is in progress (asserted), the chip select
+    ///          still held after completed character operations is
+    ///          released.
+    /// @param id Chip select.
+    /// @param txBuf Data to transmit, when nullptr the fill character
+    ///        (see setFillChar()) is transmitted.
+    /// @param rxBuf Buffer for received data, when nullptr the received
+    ///        data is discarded.
+    /// @param length Number of characters to exchange.
+    void startTransfer(
+        DeviceIdType id,
+        const CharType* txBuf,
+        CharType* rxBuf,
+        std::size_t length,
+        EventLoopContext context);
+
+    bool cancelTransfer(EventLoopContext context);
+
+    /// @brief Start transaction of several phases (such as command,
+    ///        address, dummy and data) with chip select held active.
+    /// @details The phases are transferred back to back as single
+    ///          continuous burst, the chip select is released only when
+    ///          the last one is complete. The phase descriptors are copied,
+    ///          the buffers they point to must stay valid until the
+    ///          completion handler (see setTransferCompleteHandler()) is
+    ///          invoked. Same restrictions as for startTransfer() apply.
+    /// @param id Chip select.
+    /// @param phases Phases, every one of non-zero length.
+    /// @param count Number of phases, up to MaxTransactionPhases.
+    void startTransaction(
+        DeviceIdType id,
+        const TransferPhase* phases,
+        std::size_t count,
+        EventLoopContext context);
+
+    std::size_t getPolledTransferThreshold() const;
+
+    /// @brief Set maximal length of the transfer performed by polling
+    ///        (see tryTransferPolled()).
+    /// @details Zero disables the polling, the value can't exceed the
+    ///          FIFO size (16), which is also the default.
+    void setPolledTransferThreshold(std::size_t length);
+
+    /// @brief Perform short full duplex transfer synchronously.
+    /// @details The whole transfer is put into the FIFO and the function
+    ///          busy waits for its completion, no interrupt is involved.
+    ///          The parameters have the same meaning as for startTransfer().
+    /// @return true if the transfer was performed, false if its length
+    ///         exceeds the threshold (see setPolledTransferThreshold()) or
+    ///         other operation is in progress.
+    bool tryTransferPolled(
+        DeviceIdType id,
+        const CharType* txBuf,
+        CharType* rxBuf,
+        std::size_t length,
+        EventLoopContext context);
+
+    /// @brief Perform full duplex transfer using the fastest way.
+    /// @details The transfer is performed by polling if possible (see
+    ///          tryTransferPolled()), otherwise interrupt driven transfer is
+    ///          started (see startTransfer()).
+    /// @return true if the transfer was completed synchronously, the
+    ///         completion handler is invoked only when false is returned.
+    bool transfer(
+        DeviceIdType id,
+        const CharType* txBuf,
+        CharType* rxBuf,
+        std::size_t length,
+        EventLoopContext context);
+
+    /// @brief Start full duplex transfer using DMA.
+    /// @details Both DMA channels must be provided to the constructor.
+    ///          The chip select is held active for the whole transfer and
+    ///          released automatically at its end. The completion is
+    ///          reported from the interrupt context using handler set by
+    ///          setTransferCompleteHandler(). Same restrictions as for
+    ///          startTransfer() apply.
+    /// @param id Chip select.
+    /// @param txBuf Data to transmit, when nullptr the fill character
+    ///        (see setFillChar()) is transmitted.
+    /// @param rxBuf Buffer for received data, when nullptr the received
+    ///        data is discarded.
+    /// @param count Number of words, up to MaxDmaWordsCount.
+    void startDmaTransfer(
+        DeviceIdType id,
+        const DmaWordType* txBuf,
+        DmaWordType* rxBuf,
+        std::size_t count,
+        EventLoopContext context);
+
+    bool cancelDmaTransfer(EventLoopContext context);
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
 
 private:
     typedef typename InterruptMgr::IrqId IrqId;
@@ -134,15 +287,34 @@ private:
     bool cancelWriteInternal();
     void disableInterrupts();
     void enableInterrupts();
-    void startTransfer(DeviceIdType id);
+    void beginTransfer(DeviceIdType id);
     void stopTransfer();
-    void interruptHandler();
     void reportReadComplete(const embxx::error::ErrorStatus& es);
     void reportWriteComplete(const embxx::error::ErrorStatus& es);
     void readFromFifo(std::size_t maxCount);
     void writeToFifo(std::size_t maxCount);
     bool readOpInProgress() const;
     bool writeOpInProgress() const;
+    bool transferInProgress() const;
+    void serviceTransfer();
+    void initDma(std::nullptr_t* txDma, std::nullptr_t* rxDma);
+    template <typename TDma>
+    void initDma(TDma* txDma, TDma* rxDma);
+    void dmaTxComplete(const embxx::error::ErrorStatus& status);
+    void dmaRxComplete(const embxx::error::ErrorStatus& status);
+    void stopDmaTransfer();
+    bool dmaTransferInProgress() const;
+
+    // Current user of the bus (transfer active line and chip select)
+    enum BusUser {
+        BusUser_None,
+        BusUser_Character,
+        BusUser_Transfer,
+        BusUser_Polled,
+        BusUser_Dma
+    };
+    bool claimBus(BusUser user);
+    void releaseBus();
 
     InterruptMgr& interruptMgr_;
     CanReadHandler canReadHandler_;
@@ -155,6 +327,20 @@ private:
     std::size_t writeFifoSize_;
     volatile EntryType csCache_;
     CharType fillChar_;
+    TransferCompleteHandler transferCompleteHandler_;
+    std::array<TransferPhase, MaxTransactionPhases> phases_;
+    std::size_t txPhaseIdx_;
+    std::size_t txPhaseOffset_;
+    std::size_t rxPhaseIdx_;
+    std::size_t rxPhaseOffset_;
+    std::size_t transferTxRemaining_;
+    std::size_t transferRxRemaining_;
+    std::size_t polledTransferThreshold_;
+    DmaChannel* txDma_;
+    DmaChannel* rxDma_;
+    DmaWordType dmaTxFillWord_;
+    DmaWordType dmaRxDiscardWord_;
+    BusUser busUser_;
 
     typedef Function::PinIdxType PinIdxType;
     typedef Function::FuncSel FuncSel;
@@ -174,6 +360,8 @@ private:
 
     static constexpr auto pSPI0_CS =
         reinterpret_cast<volatile EntryType*>(0x20204000);
+    static const std::size_t MaxFifoLen = 16U;
+
     static const std::size_t SPI0_CS_CS_Pos = 0;
     static const std::size_t SPI0_CS_CS_Len = 2;
     static const std::size_t SPI0_CS_ModePos = 2;
@@ -181,8 +369,10 @@ private:
     static const std::size_t SPI0_CS_CLEAR_Pos = 4;
     static const std::size_t SPI0_CS_CLEAR_Len = 2;
     static const std::size_t SPI0_CS_TA_Pos = 7;
+    static const std::size_t SPI0_CS_DMAEN_Pos = 8;
     static const std::size_t SPI0_CS_INTD_Pos = 9;
     static const std::size_t SPI0_CS_INTR_Pos = 10;
+    static const std::size_t SPI0_CS_ADCS_Pos = 11;
     static const std::size_t SPI0_CS_DONE_Pos = 16;
     static const std::size_t SPI0_CS_RXD_Pos = 17;
     static const std::size_t SPI0_CS_TXD_Pos = 18;
@@ -197,12 +387,15 @@ private:
     static const EntryType SPI0_CS_TA = genMask(SPI0_CS_TA_Pos);
     static const EntryType SPI0_CS_INTD = genMask(SPI0_CS_INTD_Pos);
     static const EntryType SPI0_CS_INTR = genMask(SPI0_CS_INTR_Pos);
+    static const EntryType SPI0_CS_DMAEN = genMask(SPI0_CS_DMAEN_Pos);
+    static const EntryType SPI0_CS_ADCS = genMask(SPI0_CS_ADCS_Pos);
     static const EntryType SPI0_CS_DONE = genMask(SPI0_CS_DONE_Pos);
     static const EntryType SPI0_CS_RXD = genMask(SPI0_CS_RXD_Pos);
     static const EntryType SPI0_CS_TXD = genMask(SPI0_CS_TXD_Pos);
     static const EntryType SPI0_CS_RXR = genMask(SPI0_CS_RXR_Pos);
 
     static const EntryType TranfserActiveMask = SPI0_CS_TA | SPI0_CS_INTD | SPI0_CS_INTR;
+    static const EntryType DmaTransferActiveMask = SPI0_CS_TA | SPI0_CS_DMAEN | SPI0_CS_ADCS;
 
 
     static const std::size_t pSPI0_CS_FifoNeedsReadStatusPos = 19;
@@ -216,23 +409,41 @@ private:
 
     static const std::size_t pSPI0_CLK_CDIV_Pos = 0;
     static const std::size_t pSPI0_CLK_CDIV_Len = 15;
+
+    static constexpr auto pSPI0_DLEN =
+        reinterpret_cast<volatile EntryType*>(0x2020400C);
 };
 
 // Implementation
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::Spi0(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::Spi0(
     InterruptMgr& interruptMgr,
     Function& funcDev,
-    Mode mode)
+    Mode mode,
+    DmaChannel* txDma,
+    DmaChannel* rxDma)
     : interruptMgr_(interruptMgr),
       remainingReadLen_(0),
       remainingWriteLen_(0),
       readFifoSize_(0),
       writeFifoSize_(0),
       csCache_(0),
-      fillChar_(0)
+      fillChar_(0),
+      txPhaseIdx_(0),
+      txPhaseOffset_(0),
+      rxPhaseIdx_(0),
+      rxPhaseOffset_(0),
+      transferTxRemaining_(0),
+      transferRxRemaining_(0),
+      polledTransferThreshold_(MaxFifoLen),
+      txDma_(txDma),
+      rxDma_(rxDma),
+      dmaTxFillWord_(0),
+      dmaRxDiscardWord_(0),
+      busUser_(BusUser_None)
 {
     funcDev.configure(LineCS0, AltFuncAll);
     funcDev.configure(LineCS1, AltFuncAll);
@@ -245,14 +456,16 @@ Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::Spi0(
         std::bind(&Spi0::interruptHandler, this));
 
     setMode(mode);
+    initDma(txDma_, rxDma_);
 
     *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-unsigned Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getFreq(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+unsigned Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::getFreq(
     unsigned sysFreq)
 {
     static const unsigned ZeroDiv =
@@ -268,8 +481,9 @@ unsigned Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getFreq(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFreq(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::setFreq(
     unsigned sysFreq,
     unsigned busFreq)
 {
@@ -311,9 +525,10 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFreq(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::Mode
-Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getMode() const
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::Mode
+Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::getMode() const
 {
     auto mode =
         csCache_ & genMask(SPI0_CS_ModePos, SPI0_CS_ModeLen) >> SPI0_CS_ModeLen;
@@ -322,8 +537,9 @@ Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getMode() const
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setMode(Mode mode)
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::setMode(Mode mode)
 {
     static const auto Mask = genMask(SPI0_CS_ModePos, SPI0_CS_ModeLen);
     csCache_&= ~Mask;
@@ -332,17 +548,19 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setMode(Mode mode)
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::CharType
-Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getFillChar() const
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::CharType
+Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::getFillChar() const
 {
     return fillChar_;
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFillChar(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::setFillChar(
     CharType ch)
 {
     fillChar_ = ch;
@@ -350,9 +568,10 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::setFillChar(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
 template <typename TFunc>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
 setCanReadHandler(
     TFunc&& func)
 {
@@ -361,9 +580,10 @@ setCanReadHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
 template <typename TFunc>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
 setCanWriteHandler(
     TFunc&& func)
 {
@@ -372,9 +592,10 @@ setCanWriteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
 template <typename TFunc>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
 setReadCompleteHandler(
     TFunc&& func)
 {
@@ -383,9 +604,10 @@ setReadCompleteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
 template <typename TFunc>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
 setWriteCompleteHandler(
     TFunc&& func)
 {
@@ -394,8 +616,9 @@ setWriteCompleteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startRead(
     DeviceIdType id,
     std::size_t length,
     EventLoopContext context)
@@ -408,8 +631,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startRead(
     DeviceIdType id,
     std::size_t length,
     InterruptContext context)
@@ -420,8 +644,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startRead(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelRead(
     EventLoopContext context)
 {
     static_cast<void>(context);
@@ -433,8 +658,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelRead(
     InterruptContext context)
 {
     static_cast<void>(context);
@@ -443,8 +669,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelRead(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startWrite(
     DeviceIdType id,
     std::size_t length,
     EventLoopContext context)
@@ -457,8 +684,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startWrite(
     DeviceIdType id,
     std::size_t length,
     InterruptContext context)
@@ -469,8 +697,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWrite(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelWrite(
     EventLoopContext context)
 {
     static_cast<void>(context);
@@ -482,8 +711,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelWrite(
     InterruptContext context)
 {
     static_cast<void>(context);
@@ -492,8 +722,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWrite(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::suspend(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::suspend(
     EventLoopContext context)
 {
     disableInterrupts();
@@ -502,8 +733,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::suspend(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::resume(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::resume(
     EventLoopContext context)
 {
     GASSERT(readOpInProgress() || writeOpInProgress());
@@ -512,8 +744,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::resume(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canRead(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::canRead(
     InterruptContext context)
 {
     static_cast<void>(context);
@@ -523,8 +756,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canRead(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canWrite(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::canWrite(
     InterruptContext context)
 {
     static_cast<void>(context);
@@ -534,9 +768,10 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::canWrite(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::CharType
-Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::read(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::CharType
+Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::read(
     InterruptContext context)
 {
     static_cast<void>(context);
@@ -548,8 +783,9 @@ Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::read(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::write(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::write(
     CharType value,
     InterruptContext context)
 {
@@ -562,8 +798,276 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::write(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::selectChip(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setTransferCompleteHandler(
+    TFunc&& func)
+{
+    transferCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startTransfer(
+    DeviceIdType id,
+    const CharType* txBuf,
+    CharType* rxBuf,
+    std::size_t length,
+    EventLoopContext context)
+{
+    TransferPhase phase = {txBuf, rxBuf, length};
+    startTransaction(id, &phase, 1, context);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startTransaction(
+    DeviceIdType id,
+    const TransferPhase* phases,
+    std::size_t count,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT((0 < count) && (count <= phases_.size()));
+
+    disableInterrupts();
+    bool claimed = claimBus(BusUser_Transfer);
+    GASSERT(claimed);
+    static_cast<void>(claimed);
+
+    std::size_t totalLength = 0;
+    for (std::size_t idx = 0; idx < count; ++idx) {
+        GASSERT(0 < phases[idx].length_);
+        phases_[idx] = phases[idx];
+        totalLength += phases[idx].length_;
+    }
+
+    txPhaseIdx_ = 0;
+    txPhaseOffset_ = 0;
+    rxPhaseIdx_ = 0;
+    rxPhaseOffset_ = 0;
+    transferTxRemaining_ = totalLength;
+    transferRxRemaining_ = totalLength;
+    *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
+    beginTransfer(id); // DONE interrupt fills the FIFO
+    enableInterrupts();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelTransfer(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    disableInterrupts();
+    bool result = transferInProgress();
+    if (result) {
+        transferTxRemaining_ = 0;
+        transferRxRemaining_ = 0;
+        stopTransfer();
+        *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
+    }
+    enableInterrupts();
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+std::size_t Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::getPolledTransferThreshold() const
+{
+    return polledTransferThreshold_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::setPolledTransferThreshold(
+    std::size_t length)
+{
+    GASSERT(length <= MaxFifoLen);
+    polledTransferThreshold_ = length;
+    if (MaxFifoLen < polledTransferThreshold_) {
+        polledTransferThreshold_ = MaxFifoLen;
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::tryTransferPolled(
+    DeviceIdType id,
+    const CharType* txBuf,
+    CharType* rxBuf,
+    std::size_t length,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(0 < length);
+    if (polledTransferThreshold_ < length) {
+        return false;
+    }
+
+    disableInterrupts();
+    if (!claimBus(BusUser_Polled)) {
+        enableInterrupts();
+        return false;
+    }
+
+    GASSERT(length <= MaxFifoLen);
+    selectChip(id);
+    *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
+    *pSPI0_CS = csCache_ | SPI0_CS_TA;
+
+    // Whole transfer fits into the FIFO
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        auto ch = fillChar_;
+        if (txBuf != nullptr) {
+            ch = txBuf[idx];
+        }
+        *pSPI0_FIFO = ch;
+    }
+
+    while ((*pSPI0_CS & SPI0_CS_DONE) == 0) {}
+
+    for (std::size_t idx = 0; idx < length; ++idx) {
+        GASSERT((*pSPI0_CS & SPI0_CS_RXD) != 0);
+        auto ch = static_cast<CharType>(*pSPI0_FIFO);
+        if (rxBuf != nullptr) {
+            rxBuf[idx] = ch;
+        }
+    }
+
+    *pSPI0_CS = csCache_;
+    releaseBus();
+    enableInterrupts();
+    return true;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::transfer(
+    DeviceIdType id,
+    const CharType* txBuf,
+    CharType* rxBuf,
+    std::size_t length,
+    EventLoopContext context)
+{
+    if (tryTransferPolled(id, txBuf, rxBuf, length, context)) {
+        return true;
+    }
+
+    startTransfer(id, txBuf, rxBuf, length, context);
+    return false;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startDmaTransfer(
+    DeviceIdType id,
+    const DmaWordType* txBuf,
+    DmaWordType* rxBuf,
+    std::size_t count,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT((txDma_ != nullptr) && (rxDma_ != nullptr));
+    GASSERT((0 < count) && (count <= MaxDmaWordsCount));
+
+    disableInterrupts();
+    bool claimed = claimBus(BusUser_Dma);
+    GASSERT(claimed);
+    static_cast<void>(claimed);
+    enableInterrupts();
+
+    selectChip(id);
+    *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
+    *pSPI0_DLEN = static_cast<EntryType>(count * sizeof(DmaWordType));
+
+    auto lengthBytes = count * sizeof(DmaWordType);
+    if (rxBuf != nullptr) {
+        rxDma_->startRead(
+            pSPI0_FIFO,
+            rxBuf,
+            lengthBytes,
+            DmaChannel::Peripheral_SpiRx);
+    }
+    else {
+        rxDma_->startRead(
+            pSPI0_FIFO,
+            &dmaRxDiscardWord_,
+            lengthBytes,
+            DmaChannel::Peripheral_SpiRx,
+            false);
+    }
+
+    if (txBuf != nullptr) {
+        txDma_->startWrite(
+            txBuf,
+            pSPI0_FIFO,
+            lengthBytes,
+            DmaChannel::Peripheral_SpiTx);
+    }
+    else {
+        dmaTxFillWord_ =
+            static_cast<DmaWordType>(fillChar_) * static_cast<DmaWordType>(0x01010101);
+        txDma_->startWrite(
+            &dmaTxFillWord_,
+            pSPI0_FIFO,
+            lengthBytes,
+            DmaChannel::Peripheral_SpiTx,
+            false);
+    }
+
+    // The chip select is deasserted by the hardware (ADCS) when DLEN
+    // characters have been transferred.
+    *pSPI0_CS = csCache_ | DmaTransferActiveMask;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelDmaTransfer(
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT((txDma_ != nullptr) && (rxDma_ != nullptr));
+
+    // The DMA completion interrupts must not report the transfer between
+    // the check and the stop.
+    auto flags = interrupt::save();
+    interrupt::disable();
+    bool result = dmaTransferInProgress();
+    if (result) {
+        txDma_->cancel();
+        rxDma_->cancel();
+        stopDmaTransfer();
+    }
+    interrupt::restore(flags);
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::selectChip(
     DeviceIdType id)
 {
     GASSERT(id < SupportedDeviceIdsCount);
@@ -574,25 +1078,31 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::selectChip(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::DeviceIdType
-Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::getChip() const
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+typename Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::DeviceIdType
+Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::getChip() const
 {
     return (csCache_ & SPI0_CS_CS) >> SPI0_CS_CS_Pos;
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startReadInternal(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startReadInternal(
     DeviceIdType id,
     std::size_t length)
 {
     GASSERT(remainingReadLen_ == 0);
     GASSERT(0 < length);
+    // Character operations are queued by the driver, the bus mustn't be
+    // used by the transfers at the same time.
+    GASSERT((busUser_ == BusUser_None) || (busUser_ == BusUser_Character));
     remainingReadLen_ = length;
-    if ((csCache_ & TranfserActiveMask) == 0) {
-        startTransfer(id);
+    if (busUser_ == BusUser_None) {
+        busUser_ = BusUser_Character;
+        beginTransfer(id);
     }
     else {
         GASSERT(getChip() == id);
@@ -602,17 +1112,21 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startReadInternal(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWriteInternal(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::startWriteInternal(
     DeviceIdType id,
     std::size_t length)
 {
     GASSERT(remainingWriteLen_ == 0);
     GASSERT(0 < length);
+    // Character operations are queued by the driver, the bus mustn't be
+    // used by the transfers at the same time.
+    GASSERT((busUser_ == BusUser_None) || (busUser_ == BusUser_Character));
     remainingWriteLen_ = length;
-
-    if ((csCache_ & TranfserActiveMask) == 0) {
-        startTransfer(id);
+    if (busUser_ == BusUser_None) {
+        busUser_ = BusUser_Character;
+        beginTransfer(id);
     }
     else {
         GASSERT(getChip() == id);
@@ -622,8 +1136,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startWriteInternal(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelReadInternal()
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelReadInternal()
 {
     bool result = false;
     if (readOpInProgress()) {
@@ -636,8 +1151,9 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelReadInternal(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWriteInternal()
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::cancelWriteInternal()
 {
     bool result = false;
     if (writeOpInProgress()) {
@@ -650,27 +1166,30 @@ bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::cancelWriteInternal
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::disableInterrupts()
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::disableInterrupts()
 {
     interruptMgr_.disableInterrupt(IrqId::IrqId_SPI);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::enableInterrupts()
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::enableInterrupts()
 {
     interruptMgr_.enableInterrupt(IrqId::IrqId_SPI);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startTransfer(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::beginTransfer(
     DeviceIdType id)
 {
-    GASSERT(writeOpInProgress() || readOpInProgress());
+    GASSERT(writeOpInProgress() || readOpInProgress() || transferInProgress());
     GASSERT((csCache_ & TranfserActiveMask) == 0);
     selectChip(id);
     csCache_ |= TranfserActiveMask;
@@ -679,25 +1198,36 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::startTransfer(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::stopTransfer()
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::stopTransfer()
 {
     csCache_ &= ~(TranfserActiveMask);
     *pSPI0_CS = csCache_;
+    releaseBus();
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
 interruptHandler()
 {
+    if (transferInProgress()) {
+        serviceTransfer();
+        return;
+    }
+
+    if (busUser_ != BusUser_Character) {
+        return;
+    }
+
     if ((!readOpInProgress()) && (!writeOpInProgress())) {
         stopTransfer();
         return;
     }
 
-    static const std::size_t MaxFifoLen = 16U;
     static const std::size_t MidOpFifoLen = 12U;
 
     volatile auto csValue = *pSPI0_CS;
@@ -749,8 +1279,9 @@ interruptHandler()
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportReadComplete(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::reportReadComplete(
     const embxx::error::ErrorStatus& es)
 {
     GASSERT(readCompleteHandler_);
@@ -760,8 +1291,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportReadComplete(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportWriteComplete(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::reportWriteComplete(
     const embxx::error::ErrorStatus& es)
 {
     GASSERT(writeCompleteHandler_);
@@ -771,8 +1303,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::reportWriteComplete
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::readFromFifo(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::readFromFifo(
     std::size_t maxCount)
 {
     if ((*pSPI0_CS & SPI0_CS_RXD) == 0) {
@@ -799,8 +1332,9 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::readFromFifo(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::writeToFifo(
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::writeToFifo(
     std::size_t maxCount)
 {
     if ((*pSPI0_CS & SPI0_CS_TXD) == 0) {
@@ -826,19 +1360,205 @@ void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::writeToFifo(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::readOpInProgress() const
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::readOpInProgress() const
 {
     return (0 < remainingReadLen_);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::writeOpInProgress() const
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::writeOpInProgress() const
 {
     return (0 < remainingWriteLen_);
 }
 
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::transferInProgress() const
+{
+    return (0 < transferRxRemaining_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::serviceTransfer()
+{
+    while ((0 < transferRxRemaining_) &&
+           ((*pSPI0_CS & SPI0_CS_RXD) != 0)) {
+        auto ch = static_cast<CharType>(*pSPI0_FIFO);
+        auto& phase = phases_[rxPhaseIdx_];
+        if (phase.rxBuf_ != nullptr) {
+            phase.rxBuf_[rxPhaseOffset_] = ch;
+        }
+
+        ++rxPhaseOffset_;
+        if (rxPhaseOffset_ == phase.length_) {
+            ++rxPhaseIdx_;
+            rxPhaseOffset_ = 0;
+        }
+        --transferRxRemaining_;
+    }
+
+    // Limit number of characters in flight to the FIFO size, the RX FIFO
+    // mustn't overflow before the next interrupt.
+    GASSERT(transferTxRemaining_ <= transferRxRemaining_);
+    while ((0 < transferTxRemaining_) &&
+           ((transferRxRemaining_ - transferTxRemaining_) < MaxFifoLen) &&
+           ((*pSPI0_CS & SPI0_CS_TXD) != 0)) {
+        auto& phase = phases_[txPhaseIdx_];
+        auto ch = fillChar_;
+        if (phase.txBuf_ != nullptr) {
+            ch = phase.txBuf_[txPhaseOffset_];
+        }
+        *pSPI0_FIFO = ch;
+
+        ++txPhaseOffset_;
+        if (txPhaseOffset_ == phase.length_) {
+            ++txPhaseIdx_;
+            txPhaseOffset_ = 0;
+        }
+        --transferTxRemaining_;
+    }
+
+    if (transferRxRemaining_ == 0) {
+        stopTransfer();
+        GASSERT(transferCompleteHandler_);
+        transferCompleteHandler_(embxx::error::ErrorCode::Success);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::initDma(
+    std::nullptr_t* txDma,
+    std::nullptr_t* rxDma)
+{
+    // DMA is not supported
+    static_cast<void>(txDma);
+    static_cast<void>(rxDma);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TDma>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::initDma(
+    TDma* txDma,
+    TDma* rxDma)
+{
+    if (txDma != nullptr) {
+        txDma->setCompleteHandler(
+            std::bind(&Spi0::dmaTxComplete, this, std::placeholders::_1));
+    }
+
+    if (rxDma != nullptr) {
+        rxDma->setCompleteHandler(
+            std::bind(&Spi0::dmaRxComplete, this, std::placeholders::_1));
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::dmaTxComplete(
+    const embxx::error::ErrorStatus& status)
+{
+    if ((!status) || (!dmaTransferInProgress())) {
+        // The transfer completes when the last character is received
+        return;
+    }
+
+    rxDma_->cancel();
+    stopDmaTransfer();
+    GASSERT(transferCompleteHandler_);
+    transferCompleteHandler_(status);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::dmaRxComplete(
+    const embxx::error::ErrorStatus& status)
+{
+    if (!dmaTransferInProgress()) {
+        return;
+    }
+
+    if (status) {
+        txDma_->cancel();
+    }
+
+    stopDmaTransfer();
+    GASSERT(transferCompleteHandler_);
+    transferCompleteHandler_(status);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::stopDmaTransfer()
+{
+    *pSPI0_CS = csCache_ | SPI0_CS_CLEAR;
+    *pSPI0_DLEN = 0;
+    releaseBus();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::dmaTransferInProgress() const
+{
+    return (busUser_ == BusUser_Dma);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::claimBus(
+    BusUser user)
+{
+    // Expected to be called with SPI interrupt disabled
+    GASSERT(user != BusUser_Character);
+    if ((busUser_ == BusUser_Character) &&
+        (!readOpInProgress()) &&
+        (!writeOpInProgress())) {
+        // Chip select is still held after completed character operations,
+        // release it.
+        stopTransfer();
+    }
+
+    if (busUser_ != BusUser_None) {
+        return false;
+    }
+
+    busUser_ = user;
+    return true;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Spi0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::releaseBus()
+{
+    busUser_ = BusUser_None;
+}
+
 }  // namespace device
 
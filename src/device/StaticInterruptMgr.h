@@ -0,0 +1,219 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+
+#include "embxx/util/Assert.h"
+
+#include "InterruptMgr.h"
+#include "InterruptMap.h"
+
+namespace device
+{
+
+/// @brief Compile time binding of the interrupt source to its handler.
+/// @tparam TId Interrupt source.
+/// @tparam TFunc Handler function, usually forwards the call to
+///         interruptHandler() member function of the relevant device.
+template <InterruptIds::IrqId TId, void (*TFunc)()>
+struct StaticIrqBinding
+{
+    static const InterruptIds::IrqId Id = TId;
+
+    static void invoke()
+    {
+        TFunc();
+    }
+};
+
+namespace details
+{
+
+template <typename... TBindings>
+struct StaticIrqDispatcher;
+
+template <>
+struct StaticIrqDispatcher<>
+{
+    static void dispatch(const std::uint32_t* pending)
+    {
+        static_cast<void>(pending);
+    }
+
+    static constexpr bool isBound(InterruptIds::IrqId)
+    {
+        return false;
+    }
+};
+
+template <typename TFirst, typename... TRest>
+struct StaticIrqDispatcher<TFirst, TRest...>
+{
+    static void dispatch(const std::uint32_t* pending)
+    {
+        const interrupt::RegIdx PendingReg =
+            interrupt::getLocation(TFirst::Id).pendingReg_;
+        const std::uint32_t PendingMask =
+            interrupt::getLocation(TFirst::Id).pendingMask_;
+        if ((pending[PendingReg] & PendingMask) != 0) {
+            TFirst::invoke();
+        }
+        StaticIrqDispatcher<TRest...>::dispatch(pending);
+    }
+
+    static constexpr bool isBound(InterruptIds::IrqId id)
+    {
+        return (TFirst::Id == id) || StaticIrqDispatcher<TRest...>::isBound(id);
+    }
+};
+
+}  // namespace details
+
+/// @brief Interrupt manager with compile time list of handlers.
+/// @details Drop-in replacement of InterruptMgr for the devices, the
+///          handlers passed to registerHandler() are ignored, the
+///          ones specified by the bindings are invoked directly instead.
+///          The handlers are invoked in the order of the bindings.
+///          Registration or enabling of the source without binding is
+///          reported by assertion failure, such source would never be
+///          serviced and would keep the interrupt asserted.
+///          Priorities, FIQ routing and statistics are not supported.
+/// @tparam TBindings List of StaticIrqBinding types.
+template <typename... TBindings>
+class StaticInterruptMgr : public InterruptIds
+{
+public:
+    StaticInterruptMgr();
+
+    /// @brief Check whether the handler of the source is bound.
+    static constexpr bool isBound(IrqId id);
+
+    template <typename TFunc>
+    void registerHandler(IrqId id, TFunc&& handler);
+
+    void enableInterrupt(IrqId id);
+
+    void disableInterrupt(IrqId id);
+
+    void handleInterrupt();
+
+private:
+    typedef std::uint32_t EntryType;
+
+    static const std::size_t NumOfRegs = interrupt::RegIdx_NumOfRegs;
+    typedef std::array<EntryType, NumOfRegs> RegMasks;
+
+    void updateActiveMask(IrqId id, bool enabled);
+
+    RegMasks activeMasks_;
+};
+
+// Implementation
+
+template <typename... TBindings>
+StaticInterruptMgr<TBindings...>::StaticInterruptMgr()
+{
+    activeMasks_.fill(0);
+}
+
+template <typename... TBindings>
+constexpr bool StaticInterruptMgr<TBindings...>::isBound(IrqId id)
+{
+    return details::StaticIrqDispatcher<TBindings...>::isBound(id);
+}
+
+template <typename... TBindings>
+template <typename TFunc>
+void StaticInterruptMgr<TBindings...>::registerHandler(
+    IrqId id,
+    TFunc&& handler)
+{
+    // Handlers are bound at compile time, the binding must exist
+    GASSERT(isBound(id));
+    static_cast<void>(id);
+    static_cast<void>(handler);
+}
+
+template <typename... TBindings>
+void StaticInterruptMgr<TBindings...>::enableInterrupt(IrqId id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    GASSERT(isBound(id));
+    updateActiveMask(id, true);
+    auto location = interrupt::getLocation(id);
+    *interrupt::enableReg(location.enDisReg_) = location.enDisMask_;
+}
+
+template <typename... TBindings>
+void StaticInterruptMgr<TBindings...>::disableInterrupt(IrqId id)
+{
+    GASSERT(id < IrqId_NumOfIds);
+    auto location = interrupt::getLocation(id);
+    *interrupt::disableReg(location.enDisReg_) = location.enDisMask_;
+    updateActiveMask(id, false);
+}
+
+template <typename... TBindings>
+void StaticInterruptMgr<TBindings...>::handleInterrupt()
+{
+    EntryType pending[NumOfRegs];
+    pending[interrupt::RegIdx_Basic] =
+        *interrupt::pendingReg(interrupt::RegIdx_Basic);
+    pending[interrupt::RegIdx_1] = 0;
+    pending[interrupt::RegIdx_2] = 0;
+
+    if ((pending[interrupt::RegIdx_Basic] & interrupt::BasicPending1Mask) != 0) {
+        pending[interrupt::RegIdx_1] =
+            *interrupt::pendingReg(interrupt::RegIdx_1);
+    }
+
+    if ((pending[interrupt::RegIdx_Basic] & interrupt::BasicPending2Mask) != 0) {
+        pending[interrupt::RegIdx_2] =
+            *interrupt::pendingReg(interrupt::RegIdx_2);
+    }
+
+    for (auto idx = 0U; idx < NumOfRegs; ++idx) {
+        pending[idx] &= activeMasks_[idx];
+    }
+
+    details::StaticIrqDispatcher<TBindings...>::dispatch(&pending[0]);
+}
+
+template <typename... TBindings>
+void StaticInterruptMgr<TBindings...>::updateActiveMask(
+    IrqId id,
+    bool enabled)
+{
+    // May be invoked from both event loop and interrupt contexts
+    auto location = interrupt::getLocation(id);
+    auto flags = interrupt::save();
+    interrupt::disable();
+    auto& mask = activeMasks_[location.pendingReg_];
+    if (enabled) {
+        mask |= location.pendingMask_;
+    }
+    else {
+        mask &= ~location.pendingMask_;
+    }
+    interrupt::restore(flags);
+}
+
+}  // namespace device
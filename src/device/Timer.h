@@ -56,6 +56,16 @@ public:
 
     unsigned getElapsed(embxx::device::context::EventLoop context) const;
 
+    /// @brief Get latency of the last timer interrupt handling in microseconds.
+    /// @details Measured as time elapsed from the timer expiry until the
+    ///          invocation of the interrupt handler.
+    unsigned getLastIrqLatency() const;
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
 private:
     typedef std::uint32_t EntryType;
     typedef typename InterruptMgr::IrqId IrqId;
@@ -64,12 +74,11 @@ private:
     void enableInterrupts();
     void disableInterrupts();
     bool configWait(WaitTimeType millisecs);
-    void interruptHandler();
-
 
     InterruptMgr& interruptMgr_;
     HandlerFunc handler_;
     bool waitInProgress_;
+    EntryType lastIrqLatencyTicks_;
 
     static const unsigned SysClockFreq = 1000000; // 1 MHz - calculated by trial and error
 
@@ -123,7 +132,8 @@ template <typename TInterruptMgr,
           typename THandler>
 Timer<TInterruptMgr, THandler>::Timer(InterruptMgr& interruptMgr)
     : interruptMgr_(interruptMgr),
-      waitInProgress_(false)
+      waitInProgress_(false),
+      lastIrqLatencyTicks_(0)
 {
     // Make it 32 bit counter by default
     *ControlReg |= ControlRegCounterTypeMask;
@@ -213,6 +223,23 @@ unsigned Timer<TInterruptMgr, THandler>::getElapsed(
     return elapsedTicks / TicksInMillisec;
 }
 
+template <typename TInterruptMgr,
+          typename THandler>
+unsigned Timer<TInterruptMgr, THandler>::getLastIrqLatency() const
+{
+    unsigned latencyTicks = lastIrqLatencyTicks_;
+    unsigned prescaler =
+        (*ControlReg & ControlRegPrescalerMask) >> ControlRegPrescalerPos;
+
+    while (0 < prescaler) {
+        latencyTicks <<= 4;
+        --prescaler;
+    }
+
+    static const unsigned TicksInMicrosec = (SysClockFreq / 1000000);
+    return latencyTicks / TicksInMicrosec;
+}
+
 template <typename TInterruptMgr,
           typename THandler>
 void Timer<TInterruptMgr, THandler>::startWaitInternal(
@@ -271,6 +298,8 @@ template <typename TInterruptMgr,
           typename THandler>
 void Timer<TInterruptMgr, THandler>::interruptHandler()
 {
+    // The counter is reloaded upon expiry and keeps counting down
+    lastIrqLatencyTicks_ = *LoadReg - *ValueReg;
     *IrqClearAckReg = 1; // Clear the interrupt
     waitInProgress_ = false;
     *ControlReg &= ~ControlRegTimerEnableMask;
@@ -0,0 +1,854 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include "embxx/util/Assert.h"
+#include "embxx/util/StaticFunction.h"
+#include "embxx/error/ErrorStatus.h"
+#include "embxx/device/context.h"
+
+#include "Function.h"
+#include "InterruptMgr.h"
+
+namespace device
+{
+
+/// @brief PL011 UART (UART0) device.
+/// @details Implements the same read/write interface as Uart1 to be used
+///          with embxx::driver::Character. The receive/transmit interrupts
+///          are raised according to the programmable FIFO levels (see
+///          setFifoLevels()), the data remaining in the receive FIFO below
+///          the level is reported by receive timeout interrupt.
+///          Uses the same pins (GPIO14, GPIO15) as Uart1, only one of the
+///          devices may be used at a time.
+/// @tparam TInterruptMgr Interrupt manager.
+/// @tparam TCanDoHandler Type of the "can read"/"can write" callbacks.
+/// @tparam TOpCompleteHandler Type of the operation completion callbacks.
+/// @tparam TDmaChannel Type of DMA channel (see DmaChannel) used for the
+///         DMA transfers. When std::nullptr_t, the DMA is not supported.
+template <typename TInterruptMgr,
+          typename TCanDoHandler = embxx::util::StaticFunction<void ()>,
+          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)>,
+          typename TDmaChannel = std::nullptr_t>
+class Uart0
+{
+public:
+
+    typedef char CharType;
+
+    typedef TInterruptMgr InterruptMgr;
+    typedef TCanDoHandler CanReadHandler;
+    typedef TCanDoHandler CanWriteHandler;
+    typedef TOpCompleteHandler ReadCompleteHandler;
+    typedef TOpCompleteHandler WriteCompleteHandler;
+    typedef TDmaChannel DmaChannel;
+
+    /// @brief Single character is transferred by DMA in every word, the
+    ///        received words also contain error flags in bits 8 - 11.
+    typedef std::uint32_t DmaWordType;
+
+    typedef typename InterruptMgr::IrqId IrqId;
+
+    typedef embxx::device::context::EventLoop EventLoopContext;
+    typedef embxx::device::context::Interrupt InterruptContext;
+
+    enum FifoLevel {
+        FifoLevel_1_8,
+        FifoLevel_1_4,
+        FifoLevel_1_2,
+        FifoLevel_3_4,
+        FifoLevel_7_8
+    };
+
+    /// @brief Constructor
+    /// @param interruptMgr Interrupt manager.
+    /// @param funcDev Pins function configuration device.
+    /// @param uartClock Frequency of UART reference clock (set by
+    ///        "init_uart_clock" in config.txt), must be at least 16 times
+    ///        the highest required baud rate.
+    /// @param txDma DMA channel for writes, may be nullptr.
+    /// @param rxDma DMA channel for reads, may be nullptr.
+    Uart0(
+        InterruptMgr& interruptMgr,
+        Function& funcDev,
+        unsigned uartClock,
+        DmaChannel* txDma = nullptr,
+        DmaChannel* rxDma = nullptr);
+
+    static void setReadEnabled(bool enabled);
+    static void setWriteEnabled(bool enabled);
+
+    /// @brief Configure baud rate.
+    /// @details The UART is disabled for the duration of the configuration,
+    ///          the contents of the FIFOs are lost.
+    void configBaud(unsigned baud);
+
+    static void setFifoLevels(FifoLevel rxLevel, FifoLevel txLevel);
+
+    template <typename TFunc>
+    void setCanReadHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setCanWriteHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setReadCompleteHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setWriteCompleteHandler(TFunc&& func);
+
+    void startRead(std::size_t length, EventLoopContext context);
+
+    template <typename TContext>
+    bool cancelRead(TContext context);
+
+    void startWrite(std::size_t length, EventLoopContext context);
+    bool cancelWrite(EventLoopContext context);
+
+    bool canRead(InterruptContext context);
+    bool canWrite(InterruptContext context);
+    CharType read(InterruptContext context);
+    void write(CharType value, InterruptContext context);
+
+    template <typename TFunc>
+    void setDmaReadCompleteHandler(TFunc&& func);
+
+    template <typename TFunc>
+    void setDmaWriteCompleteHandler(TFunc&& func);
+
+    /// @brief Start read of the characters using DMA.
+    /// @details Independent of the character read (startRead()), the
+    ///          completion is reported using handler set by
+    ///          setDmaReadCompleteHandler().
+    void startDmaRead(DmaWordType* buf, std::size_t count, EventLoopContext context);
+
+    bool cancelDmaRead(EventLoopContext context);
+
+    /// @brief Number of characters read by active or cancelled DMA read.
+    std::size_t getDmaReadCount() const;
+
+    /// @brief Start write of the characters using DMA.
+    /// @details The completion is reported when the last character is put
+    ///          into the transmit FIFO.
+    void startDmaWrite(const DmaWordType* buf, std::size_t count, EventLoopContext context);
+
+    bool cancelDmaWrite(EventLoopContext context);
+
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
+private:
+    bool cancelReadInternal();
+    void serviceRead();
+    void serviceWrite();
+    void fillTxFifo();
+    void initDma(std::nullptr_t* txDma, std::nullptr_t* rxDma);
+    template <typename TDma>
+    void initDma(TDma* txDma, TDma* rxDma);
+    void dmaReadComplete(const embxx::error::ErrorStatus& status);
+    void dmaWriteComplete(const embxx::error::ErrorStatus& status);
+    static void setReadInterruptEnabled(bool enabled);
+    static void setWriteInterruptEnabled(bool enabled);
+    static bool isReadInterruptEnabled();
+    static bool isWriteInterruptEnabled();
+
+    unsigned uartClock_;
+    CanReadHandler canReadHandler_;
+    CanWriteHandler canWriteHandler_;
+    ReadCompleteHandler readCompleteHandler_;
+    WriteCompleteHandler writeCompleteHandler_;
+    ReadCompleteHandler dmaReadCompleteHandler_;
+    WriteCompleteHandler dmaWriteCompleteHandler_;
+    std::size_t remainingReadCount_;
+    std::size_t remainingWriteCount_;
+    DmaChannel* txDma_;
+    DmaChannel* rxDma_;
+    std::size_t dmaReadCount_;
+
+    typedef std::uint32_t EntryType;
+    typedef Function::PinIdxType PinIdxType;
+    typedef Function::FuncSel FuncSel;
+
+    static constexpr EntryType genMask(std::size_t pos, std::size_t len = 1)
+    {
+        return ((static_cast<EntryType>(1) << len) - 1) << pos;
+    }
+
+    static const PinIdxType LineTXD0 = 14;
+    static const PinIdxType LineRXD0 = 15;
+
+    static const FuncSel AltFuncTXD0 = FuncSel::Alt0;
+    static const FuncSel AltFuncRXD0 = FuncSel::Alt0;
+
+    static constexpr auto pUART_DR =
+        reinterpret_cast<volatile EntryType*>(0x20201000);
+    static const std::size_t DataPos = 0;
+    static const std::size_t DataLen = 8;
+
+    static constexpr auto pUART_FR =
+        reinterpret_cast<const volatile EntryType*>(0x20201018);
+    static const std::size_t BusyPos = 3;
+    static const std::size_t RxFifoEmptyPos = 4;
+    static const std::size_t TxFifoFullPos = 5;
+
+    static constexpr auto pUART_IBRD =
+        reinterpret_cast<volatile EntryType*>(0x20201024);
+    static const std::size_t IntDividerLen = 16;
+
+    static constexpr auto pUART_FBRD =
+        reinterpret_cast<volatile EntryType*>(0x20201028);
+    static const std::size_t FracDividerLen = 6;
+
+    static constexpr auto pUART_LCRH =
+        reinterpret_cast<volatile EntryType*>(0x2020102C);
+    static const std::size_t FifoEnablePos = 4;
+    static const std::size_t WordLengthPos = 5;
+    static const std::size_t WordLengthLen = 2;
+
+    static constexpr auto pUART_CR =
+        reinterpret_cast<volatile EntryType*>(0x20201030);
+    static const std::size_t UartEnablePos = 0;
+    static const std::size_t TransmitEnablePos = 8;
+    static const std::size_t ReceiveEnablePos = 9;
+
+    static constexpr auto pUART_IFLS =
+        reinterpret_cast<volatile EntryType*>(0x20201034);
+    static const std::size_t TxLevelPos = 0;
+    static const std::size_t RxLevelPos = 3;
+    static const std::size_t LevelLen = 3;
+
+    // Same bits in IMSC, RIS, MIS and ICR
+    static constexpr auto pUART_IMSC =
+        reinterpret_cast<volatile EntryType*>(0x20201038);
+    static constexpr auto pUART_RIS =
+        reinterpret_cast<const volatile EntryType*>(0x2020103C);
+    static constexpr auto pUART_MIS =
+        reinterpret_cast<const volatile EntryType*>(0x20201040);
+    static constexpr auto pUART_ICR =
+        reinterpret_cast<volatile EntryType*>(0x20201044);
+    static const std::size_t RxInterruptPos = 4;
+    static const std::size_t TxInterruptPos = 5;
+    static const std::size_t RxTimeoutInterruptPos = 6;
+    static const EntryType AllInterruptsMask = genMask(0, 11);
+
+    static constexpr auto pUART_DMACR =
+        reinterpret_cast<volatile EntryType*>(0x20201048);
+    static const std::size_t RxDmaEnablePos = 0;
+    static const std::size_t TxDmaEnablePos = 1;
+    static const std::size_t DmaOnErrorPos = 2;
+
+    static void setBits(
+        volatile EntryType* entry,
+        bool value,
+        EntryType mask)
+    {
+        if (value) {
+            *entry |= mask;
+        }
+        else {
+            *entry &= (~mask);
+        }
+    }
+};
+
+// Implementation
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+Uart0(
+    InterruptMgr& interruptMgr,
+    Function& funcDev,
+    unsigned uartClock,
+    DmaChannel* txDma,
+    DmaChannel* rxDma)
+    : uartClock_(uartClock),
+      remainingReadCount_(0),
+      remainingWriteCount_(0),
+      txDma_(txDma),
+      rxDma_(rxDma),
+      dmaReadCount_(0)
+{
+    funcDev.configure(LineTXD0, AltFuncTXD0);
+    funcDev.configure(LineRXD0, AltFuncRXD0);
+
+    *pUART_CR = 0;
+    *pUART_IMSC = 0;
+    *pUART_DMACR = 0;
+    *pUART_ICR = AllInterruptsMask;
+
+    // Hardcoded to 8 bits with FIFOs enabled
+    *pUART_LCRH =
+        genMask(WordLengthPos, WordLengthLen) | genMask(FifoEnablePos);
+    setFifoLevels(FifoLevel_1_2, FifoLevel_1_8);
+    *pUART_CR = genMask(UartEnablePos);
+
+    initDma(txDma_, rxDma_);
+
+    interruptMgr.registerHandler(
+        IrqId::IrqId_Uart0,
+        std::bind(&Uart0::interruptHandler, this));
+    interruptMgr.enableInterrupt(IrqId::IrqId_Uart0);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setReadEnabled(
+    bool enabled)
+{
+    setBits(pUART_CR, enabled, genMask(ReceiveEnablePos));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setWriteEnabled(
+    bool enabled)
+{
+    setBits(pUART_CR, enabled, genMask(TransmitEnablePos));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+configBaud(
+    unsigned baud)
+{
+    // Divider = uartClock / (16 * baud) with 6 bits of fraction, rounded
+    GASSERT(0 < baud);
+    auto divider = ((uartClock_ * 4) + (baud / 2)) / baud;
+    auto intDivider = divider >> FracDividerLen;
+    auto fracDivider = divider & genMask(0, FracDividerLen);
+    GASSERT(0 < intDivider);
+    GASSERT(intDivider <= genMask(0, IntDividerLen));
+
+    auto ctrl = *pUART_CR;
+    *pUART_CR = 0;
+    while ((*pUART_FR & genMask(BusyPos)) != 0) {}
+
+    // Dividers are latched by write to LCRH, the FIFOs are flushed by
+    // disabling them.
+    auto lineCtrl = *pUART_LCRH;
+    *pUART_LCRH = lineCtrl & (~genMask(FifoEnablePos));
+    *pUART_IBRD = static_cast<EntryType>(intDivider);
+    *pUART_FBRD = static_cast<EntryType>(fracDivider);
+    *pUART_LCRH = lineCtrl;
+    *pUART_CR = ctrl;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setFifoLevels(
+    FifoLevel rxLevel,
+    FifoLevel txLevel)
+{
+    *pUART_IFLS =
+        (static_cast<EntryType>(rxLevel) << RxLevelPos) |
+        (static_cast<EntryType>(txLevel) << TxLevelPos);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setCanReadHandler(
+    TFunc&& func)
+{
+    canReadHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setCanWriteHandler(
+    TFunc&& func)
+{
+    canWriteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setReadCompleteHandler(
+    TFunc&& func)
+{
+    readCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setWriteCompleteHandler(
+    TFunc&& func)
+{
+    writeCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+startRead(std::size_t length, EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(!isReadInterruptEnabled());
+    GASSERT(remainingReadCount_ == 0);
+    GASSERT(0 < length);
+    remainingReadCount_ = length;
+    setReadInterruptEnabled(true);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TContext>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+cancelRead(TContext context)
+{
+    static_cast<void>(context);
+    return cancelReadInternal(); // The functionality is the same
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+startWrite(std::size_t length, EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(!isWriteInterruptEnabled());
+    GASSERT(remainingWriteCount_ == 0);
+    GASSERT(0 < length);
+    remainingWriteCount_ = length;
+
+    auto flags = interrupt::save();
+    interrupt::disable();
+    setWriteInterruptEnabled(true);
+    if ((*pUART_RIS & genMask(TxInterruptPos)) == 0) {
+        // The transmit interrupt is raised only when the FIFO level
+        // changes, fill the FIFO to get it going. The completion is
+        // reported by the interrupt even if all the characters fit.
+        fillTxFifo();
+    }
+    interrupt::restore(flags);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+cancelWrite(EventLoopContext context)
+{
+    static_cast<void>(context);
+    auto flags = interrupt::save();
+    interrupt::disable();
+    // All the characters may be in the FIFO with completion not reported yet
+    bool result = isWriteInterruptEnabled();
+    setWriteInterruptEnabled(false);
+    remainingWriteCount_ = 0;
+    interrupt::restore(flags);
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+canRead(InterruptContext context)
+{
+    static_cast<void>(context);
+    return (((*pUART_FR & genMask(RxFifoEmptyPos)) == 0) &&
+            (0 < remainingReadCount_));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+canWrite(InterruptContext context)
+{
+    static_cast<void>(context);
+    return (((*pUART_FR & genMask(TxFifoFullPos)) == 0) &&
+            (0 < remainingWriteCount_));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+typename Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::CharType
+Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+read(InterruptContext context)
+{
+    static_cast<void>(context);
+    GASSERT(canRead(context));
+    --remainingReadCount_;
+    return static_cast<CharType>(*pUART_DR & genMask(DataPos, DataLen));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+write(CharType value, InterruptContext context)
+{
+    static_cast<void>(context);
+    GASSERT(canWrite(context));
+    --remainingWriteCount_;
+    *pUART_DR = static_cast<EntryType>(value) & genMask(DataPos, DataLen);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setDmaReadCompleteHandler(
+    TFunc&& func)
+{
+    dmaReadCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TFunc>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setDmaWriteCompleteHandler(
+    TFunc&& func)
+{
+    dmaWriteCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+startDmaRead(
+    DmaWordType* buf,
+    std::size_t count,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(rxDma_ != nullptr);
+    GASSERT(!isReadInterruptEnabled());
+    dmaReadCount_ = count;
+    *pUART_DMACR |= genMask(RxDmaEnablePos) | genMask(DmaOnErrorPos);
+    rxDma_->startRead(
+        pUART_DR,
+        buf,
+        count * sizeof(DmaWordType),
+        DmaChannel::Peripheral_UartRx);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+cancelDmaRead(EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(rxDma_ != nullptr);
+    *pUART_DMACR &= ~(genMask(RxDmaEnablePos) | genMask(DmaOnErrorPos));
+    return rxDma_->cancel();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+std::size_t Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+getDmaReadCount() const
+{
+    GASSERT(rxDma_ != nullptr);
+    return dmaReadCount_ - (rxDma_->getRemaining() / sizeof(DmaWordType));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+startDmaWrite(
+    const DmaWordType* buf,
+    std::size_t count,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(txDma_ != nullptr);
+    GASSERT(!isWriteInterruptEnabled());
+    *pUART_DMACR |= genMask(TxDmaEnablePos);
+    txDma_->startWrite(
+        buf,
+        pUART_DR,
+        count * sizeof(DmaWordType),
+        DmaChannel::Peripheral_UartTx);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+cancelDmaWrite(EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(txDma_ != nullptr);
+    *pUART_DMACR &= ~genMask(TxDmaEnablePos);
+    return txDma_->cancel();
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+interruptHandler()
+{
+    auto status = *pUART_MIS;
+    static const EntryType ReadMask =
+        genMask(RxInterruptPos) | genMask(RxTimeoutInterruptPos);
+    if ((status & ReadMask) != 0) {
+        *pUART_ICR = ReadMask;
+        serviceRead();
+    }
+
+    if ((status & genMask(TxInterruptPos)) != 0) {
+        *pUART_ICR = genMask(TxInterruptPos);
+        serviceWrite();
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+cancelReadInternal()
+{
+    setReadInterruptEnabled(false);
+    bool result = (0 < remainingReadCount_);
+    remainingReadCount_ = 0;
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+serviceRead()
+{
+    if (!isReadInterruptEnabled()) {
+        return;
+    }
+
+    // Drain the whole FIFO, the handler is invoked again only if it
+    // stopped reading before that.
+    while (canRead(InterruptContext())) {
+        GASSERT(canReadHandler_);
+        auto prevRemaining = remainingReadCount_;
+        canReadHandler_();
+        if (prevRemaining == remainingReadCount_) {
+            break;
+        }
+    }
+
+    if (remainingReadCount_ == 0) {
+        setReadInterruptEnabled(false);
+        GASSERT(readCompleteHandler_);
+        readCompleteHandler_(embxx::error::ErrorCode::Success);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+serviceWrite()
+{
+    if (!isWriteInterruptEnabled()) {
+        return;
+    }
+
+    fillTxFifo();
+    if (remainingWriteCount_ == 0) {
+        setWriteInterruptEnabled(false);
+        GASSERT(writeCompleteHandler_);
+        writeCompleteHandler_(embxx::error::ErrorCode::Success);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+fillTxFifo()
+{
+    while (canWrite(InterruptContext())) {
+        GASSERT(canWriteHandler_);
+        auto prevRemaining = remainingWriteCount_;
+        canWriteHandler_();
+        if (prevRemaining == remainingWriteCount_) {
+            break;
+        }
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+initDma(std::nullptr_t* txDma, std::nullptr_t* rxDma)
+{
+    // DMA is not supported
+    static_cast<void>(txDma);
+    static_cast<void>(rxDma);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+template <typename TDma>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+initDma(TDma* txDma, TDma* rxDma)
+{
+    if (txDma != nullptr) {
+        txDma->setCompleteHandler(
+            std::bind(&Uart0::dmaWriteComplete, this, std::placeholders::_1));
+    }
+
+    if (rxDma != nullptr) {
+        rxDma->setCompleteHandler(
+            std::bind(&Uart0::dmaReadComplete, this, std::placeholders::_1));
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+dmaReadComplete(const embxx::error::ErrorStatus& status)
+{
+    *pUART_DMACR &= ~(genMask(RxDmaEnablePos) | genMask(DmaOnErrorPos));
+    GASSERT(dmaReadCompleteHandler_);
+    dmaReadCompleteHandler_(status);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+dmaWriteComplete(const embxx::error::ErrorStatus& status)
+{
+    *pUART_DMACR &= ~genMask(TxDmaEnablePos);
+    GASSERT(dmaWriteCompleteHandler_);
+    dmaWriteCompleteHandler_(status);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setReadInterruptEnabled(
+    bool enabled)
+{
+    setBits(
+        pUART_IMSC,
+        enabled,
+        genMask(RxInterruptPos) | genMask(RxTimeoutInterruptPos));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+void Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+setWriteInterruptEnabled(
+    bool enabled)
+{
+    setBits(pUART_IMSC, enabled, genMask(TxInterruptPos));
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+isReadInterruptEnabled()
+{
+    return ((*pUART_IMSC & genMask(RxInterruptPos)) != 0);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TDmaChannel>
+bool Uart0<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TDmaChannel>::
+isWriteInterruptEnabled()
+{
+    return ((*pUART_IMSC & genMask(TxInterruptPos)) != 0);
+}
+
+}  // namespace device
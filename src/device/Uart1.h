@@ -18,6 +18,10 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <array>
+#include <algorithm>
+#include <limits>
 
 #include "embxx/util/Assert.h"
 #include "embxx/util/StaticFunction.h"
@@ -25,13 +29,15 @@
 #include "embxx/device/context.h"
 
 #include "Function.h"
+#include "InterruptMgr.h"
 
 namespace device
 {
 
 template <typename TInterruptMgr,
           typename TCanDoHandler = embxx::util::StaticFunction<void ()>,
-          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)> >
+          typename TOpCompleteHandler = embxx::util::StaticFunction<void (const embxx::error::ErrorStatus&)>,
+          typename TAuxInterruptMgr = std::nullptr_t>
 class Uart1
 {
 public:
@@ -46,15 +52,85 @@ public:
 
     typedef typename InterruptMgr::IrqId IrqId;
 
+    /// @brief Demultiplexer of the AUX interrupt (see AuxInterruptMgr).
+    /// @details When provided, the interrupt handler is registered with
+    ///          it instead of the AUX interrupt source of the interrupt
+    ///          manager, which allows sharing the source with AuxSpi.
+    typedef TAuxInterruptMgr AuxInterruptMgr;
+
     typedef embxx::device::context::EventLoop EventLoopContext;
     typedef embxx::device::context::Interrupt InterruptContext;
 
-    Uart1(InterruptMgr& interruptMgr, Function& funcDev, unsigned sysClock);
+    /// @brief Number of free RX FIFO entries when RTS is de-asserted.
+    enum RtsLevel {
+        RtsLevel_3Spaces,
+        RtsLevel_2Spaces,
+        RtsLevel_1Space,
+        RtsLevel_4Spaces
+    };
+
+    /// @brief Segment of the gather write (see startGatherWrite()).
+    struct WriteSegment
+    {
+        const CharType* data_;
+        std::size_t length_;
+    };
+
+    static const std::size_t MaxWriteSegments = 4;
+
+    Uart1(
+        InterruptMgr& interruptMgr,
+        Function& funcDev,
+        unsigned sysClock,
+        AuxInterruptMgr* auxInterruptMgr = nullptr);
 
     static void setReadEnabled(bool enabled);
     static void setWriteEnabled(bool enabled);
     void configBaud(unsigned baud);
 
+    /// @brief Get the error of the baud rate achievable with the system
+    ///        clock, in parts per million of the requested one.
+    /// @details Returns std::numeric_limits<unsigned>::max() when the
+    ///          baud rate is out of the range supported by the divider.
+    unsigned getBaudErrorPpm(unsigned baud) const;
+
+    unsigned getBaud() const;
+
+    /// @brief Check whether the transmission is fully over.
+    /// @details True when no write is in progress and the last character
+    ///          has left the transmit shift register, i.e. the line
+    ///          parameters can be changed without corrupting the output.
+    bool isWriteIdle() const;
+
+    /// @brief Configure automatic hardware flow control.
+    /// @details RTS (GPIO17) is de-asserted when the RX FIFO has only
+    ///          rtsLevel free entries left. Transmission is paused while
+    ///          CTS (GPIO16) is de-asserted. Both signals are active low.
+    ///          The pin of the enabled signal is switched to its alternative
+    ///          function. Note that GPIO16 drives the on-board led (see
+    ///          component::OnBoardLed) and can't be used for CTS together
+    ///          with it.
+    void configFlowControl(
+        bool rtsEnabled,
+        bool ctsEnabled,
+        RtsLevel rtsLevel = RtsLevel_3Spaces);
+
+    /// @brief Number of receiver overruns (characters lost due to full
+    ///        RX FIFO) detected since construction or last
+    ///        resetOverrunCount().
+    std::size_t getOverrunCount() const;
+
+    void resetOverrunCount();
+
+    /// @brief Configure idle line timeout of the read operation.
+    /// @details When enabled, the read operation completes successfully
+    ///          with the characters received so far once there were no
+    ///          new characters for the duration of charTimes characters
+    ///          (at the configured baud rate). The timeout is measured
+    ///          using compare channel 3 of the system timer. Zero disables
+    ///          the timeout (default).
+    void setReadIdleTimeout(unsigned charTimes);
+
     template <typename TFunc>
     void setCanReadHandler(TFunc&& func);
 
@@ -75,27 +151,94 @@ public:
     void startWrite(std::size_t length, EventLoopContext context);
     bool cancelWrite(EventLoopContext context);
 
+    template <typename TFunc>
+    void setGatherWriteCompleteHandler(TFunc&& func);
+
+    /// @brief Write the list of segments directly from the interrupt handler.
+    /// @details The "can write" handler is not used, the data is streamed
+    ///          into TX FIFO straight from the segments. The segment
+    ///          descriptors are copied, the data they point to must stay
+    ///          valid until the completion handler (see
+    ///          setGatherWriteCompleteHandler()) is invoked. The gather
+    ///          write and the write started by startWrite() (character
+    ///          driver) are serialised: the one started while the other is
+    ///          in progress begins when the latter completes. Only one
+    ///          gather write may be outstanding at a time.
+    void startGatherWrite(
+        const WriteSegment* segments,
+        std::size_t count,
+        EventLoopContext context);
+
+    bool cancelGatherWrite(EventLoopContext context);
+
     bool canRead(InterruptContext context);
     bool canWrite(InterruptContext context);
     CharType read(InterruptContext context);
     void write(CharType value, InterruptContext context);
 
+    /// @brief Interrupt handler.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void interruptHandler();
+
+    /// @brief Interrupt handler of the idle line timeout.
+    /// @details Registered with the interrupt manager by the constructor,
+    ///          public to allow static binding (see StaticInterruptMgr).
+    void idleTimerInterruptHandler();
+
 private:
     bool cancelReadInternal();
+    void sampleFifoLevels();
+    void serviceRead();
+    void serviceWrite();
+    void serviceGatherWrite();
+    void releaseWriteOwner();
+    void completeRead();
+    void restartIdleTimer();
+    void stopIdleTimer();
+    void registerInterruptHandler(std::nullptr_t* auxInterruptMgr);
+    template <typename TAux>
+    void registerInterruptHandler(TAux* auxInterruptMgr);
     static void setReadInterruptEnabled(bool enabled);
     static void setWriteInterruptEnabled(bool enabled);
-    void interruptHandler();
     static bool isReadInterruptEnabled();
     static bool isWriteInterruptEnabled();
 
+    InterruptMgr& interruptMgr_;
+    Function& funcDev_;
     unsigned sysClock_;
+    unsigned baud_;
+    unsigned idleCharTimes_;
+    unsigned idleTimeoutUs_;
     CanReadHandler canReadHandler_;
     CanWriteHandler canWriteHandler_;
     ReadCompleteHandler readCompleteHandler_;
     WriteCompleteHandler writeCompleteHandler_;
+    WriteCompleteHandler gatherWriteCompleteHandler_;
+    std::size_t readLength_;
     std::size_t remainingReadCount_;
     std::size_t remainingWriteCount_;
 
+    // Current user of the transmitter
+    enum WriteOwner {
+        WriteOwner_None,
+        WriteOwner_Driver,
+        WriteOwner_Gather
+    };
+    WriteOwner writeOwner_;
+
+    std::array<WriteSegment, MaxWriteSegments> gatherSegments_;
+    std::size_t gatherSegmentsCount_;
+    std::size_t gatherSegmentIdx_;
+    std::size_t gatherSegmentPos_;
+
+    // FIFO levels sampled upon interrupt, updated by read()/write()
+    std::size_t rxFifoAvailable_;
+    std::size_t txFifoSpace_;
+    std::size_t overrunCount_;
+
+    static const std::size_t FifoSize = 8;
+
     typedef std::uint32_t EntryType;
     typedef Function::PinIdxType PinIdxType;
     typedef Function::FuncSel FuncSel;
@@ -107,9 +250,13 @@ private:
 
     static const PinIdxType LineTXD1 = 14;
     static const PinIdxType LineRXD1 = 15;
+    static const PinIdxType LineCTS1 = 16;
+    static const PinIdxType LineRTS1 = 17;
 
     static const FuncSel AltFuncTXD1 = FuncSel::Alt5;
     static const FuncSel AltFuncRXD1 = FuncSel::Alt5;
+    static const FuncSel AltFuncCTS1 = FuncSel::Alt5;
+    static const FuncSel AltFuncRTS1 = FuncSel::Alt5;
 
     static constexpr auto pAUX_ENABLES =
         reinterpret_cast<volatile EntryType*>(0x20215004);
@@ -154,16 +301,35 @@ private:
     static constexpr auto pAUX_MU_LSR_REG =
         reinterpret_cast<volatile EntryType*>(0x20215054);
     static const std::size_t DataReadyPos = 0;
+    static const std::size_t ReceiverOverrunPos = 1;
     static const std::size_t TransmitterEmptyPos = 5;
 
+    static constexpr auto pAUX_MU_STAT_REG =
+        reinterpret_cast<const volatile EntryType*>(0x20215064);
+    static const std::size_t RxFifoLevelPos = 16;
+    static const std::size_t RxFifoLevelLen = 4;
+    static const std::size_t TransmitterDonePos = 9;
+    static const std::size_t TxFifoLevelPos = 24;
+    static const std::size_t TxFifoLevelLen = 4;
 
     static constexpr auto pAUX_MU_CNTL_REG =
         reinterpret_cast<volatile EntryType*>(0x20215060);
     static const std::size_t ReceiverEnablePos = 0;
     static const std::size_t TransmitterEnablePos = 1;
+    static const std::size_t RtsAutoFlowPos = 2;
+    static const std::size_t CtsAutoFlowPos = 3;
+    static const std::size_t RtsAutoLevelPos = 4;
+    static const std::size_t RtsAutoLevelLen = 2;
+    static const std::size_t RtsAssertLevelPos = 6;
+    static const std::size_t CtsAssertLevelPos = 7;
     static const EntryType pAUX_MU_CNTL_REG_UsedBits =
         genMask(ReceiverEnablePos) |
-        genMask(TransmitterEnablePos);
+        genMask(TransmitterEnablePos) |
+        genMask(RtsAutoFlowPos) |
+        genMask(CtsAutoFlowPos) |
+        genMask(RtsAutoLevelPos, RtsAutoLevelLen) |
+        genMask(RtsAssertLevelPos) |
+        genMask(CtsAssertLevelPos);
 
     static constexpr auto pAUX_MU_BAUD_REG =
         reinterpret_cast<volatile EntryType*>(0x20215068);
@@ -172,6 +338,19 @@ private:
     static const EntryType pAUX_MU_BAUD_REG_UsedBits =
         genMask(BaudRatePos, BaudRateLen);
 
+    // System timer, counts microseconds
+    static constexpr auto pSYS_TIMER_CS =
+        reinterpret_cast<volatile EntryType*>(0x20003000);
+    static const std::size_t Match3Pos = 3;
+
+    static constexpr auto pSYS_TIMER_CLO =
+        reinterpret_cast<const volatile EntryType*>(0x20003004);
+
+    static constexpr auto pSYS_TIMER_C3 =
+        reinterpret_cast<volatile EntryType*>(0x20003018);
+
+    static const unsigned BitsPerChar = 10; // start + 8 data + stop
+
 
     static void setBits(
         volatile EntryType* entry,
@@ -195,20 +374,36 @@ private:
 // Implementation
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 Uart1(
     InterruptMgr& interruptMgr,
     Function& funcDev,
-    unsigned sysClock)
-    : sysClock_(sysClock),
+    unsigned sysClock,
+    AuxInterruptMgr* auxInterruptMgr)
+    : interruptMgr_(interruptMgr),
+      funcDev_(funcDev),
+      sysClock_(sysClock),
+      baud_(0),
+      idleCharTimes_(0),
+      idleTimeoutUs_(0),
+      readLength_(0),
       remainingReadCount_(0),
-      remainingWriteCount_(0)
+      remainingWriteCount_(0),
+      writeOwner_(WriteOwner_None),
+      gatherSegmentsCount_(0),
+      gatherSegmentIdx_(0),
+      gatherSegmentPos_(0),
+      rxFifoAvailable_(0),
+      txFifoSpace_(0),
+      overrunCount_(0)
 {
     funcDev.configure(LineTXD1, AltFuncTXD1);
     funcDev.configure(LineRXD1, AltFuncRXD1);
 
-    *pAUX_ENABLES = genMask(MiniUartEnablePos);
+    // SPI1/SPI2 may be enabled as well (see AuxSpi)
+    *pAUX_ENABLES |= genMask(MiniUartEnablePos);
 
     setReadEnabled(false);
     setWriteEnabled(false);
@@ -225,16 +420,18 @@ Uart1(
         genMask(RxInterruptPos) |
         genMask(FifoEnablePos, FifoEnableLen);
 
+    registerInterruptHandler(auxInterruptMgr);
+
     interruptMgr.registerHandler(
-        IrqId::IrqId_AuxInt,
-        std::bind(&Uart1::interruptHandler, this));
-    interruptMgr.enableInterrupt(IrqId::IrqId_AuxInt);
+        IrqId::IrqId_SystemTimer3,
+        std::bind(&Uart1::idleTimerInterruptHandler, this));
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setReadEnabled(
     bool enabled)
 {
@@ -243,8 +440,9 @@ setReadEnabled(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setWriteEnabled(
     bool enabled)
 {
@@ -253,21 +451,153 @@ setWriteEnabled(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 configBaud(
     unsigned baud)
 {
     auto regValue = ((sysClock_ / baud) / 8) - 1;
     GASSERT(regValue <= genMask(BaudRatePos, BaudRateLen));
     *pAUX_MU_BAUD_REG = static_cast<EntryType>(regValue);
+    baud_ = baud;
+    setReadIdleTimeout(idleCharTimes_);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+unsigned Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+getBaudErrorPpm(
+    unsigned baud) const
+{
+    static const unsigned InvalidError = std::numeric_limits<unsigned>::max();
+    if ((baud == 0) || ((sysClock_ / 8) < baud)) {
+        return InvalidError;
+    }
+
+    auto regValue = ((sysClock_ / baud) / 8) - 1;
+    if (genMask(BaudRatePos, BaudRateLen) < regValue) {
+        return InvalidError;
+    }
+
+    auto actualBaud = sysClock_ / ((regValue + 1) * 8);
+    auto diff = (actualBaud < baud) ? (baud - actualBaud) : (actualBaud - baud);
+    static const std::uint64_t PpmInUnit = 1000000;
+    return static_cast<unsigned>((diff * PpmInUnit) / baud);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+unsigned Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+getBaud() const
+{
+    return baud_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+isWriteIdle() const
+{
+    return
+        (!isWriteInterruptEnabled()) &&
+        ((*pAUX_MU_STAT_REG & genMask(TransmitterDonePos)) != 0);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+configFlowControl(
+    bool rtsEnabled,
+    bool ctsEnabled,
+    RtsLevel rtsLevel)
+{
+    if (rtsEnabled) {
+        funcDev_.configure(LineRTS1, AltFuncRTS1);
+    }
+
+    if (ctsEnabled) {
+        funcDev_.configure(LineCTS1, AltFuncCTS1);
+    }
+
+    static const EntryType FlowControlMask =
+        genMask(RtsAutoFlowPos) |
+        genMask(CtsAutoFlowPos) |
+        genMask(RtsAutoLevelPos, RtsAutoLevelLen) |
+        genMask(RtsAssertLevelPos) |
+        genMask(CtsAssertLevelPos);
+
+    // Assert levels are active low
+    EntryType value =
+        (*pAUX_MU_CNTL_REG & pAUX_MU_CNTL_REG_UsedBits & (~FlowControlMask)) |
+        (static_cast<EntryType>(rtsLevel) << RtsAutoLevelPos) |
+        genMask(RtsAssertLevelPos) |
+        genMask(CtsAssertLevelPos);
+
+    if (rtsEnabled) {
+        value |= genMask(RtsAutoFlowPos);
+    }
+
+    if (ctsEnabled) {
+        value |= genMask(CtsAutoFlowPos);
+    }
+
+    *pAUX_MU_CNTL_REG = value;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+std::size_t Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+getOverrunCount() const
+{
+    return overrunCount_;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+resetOverrunCount()
+{
+    overrunCount_ = 0;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+setReadIdleTimeout(unsigned charTimes)
+{
+    idleCharTimes_ = charTimes;
+    idleTimeoutUs_ = 0;
+    if ((charTimes == 0) || (baud_ == 0)) {
+        return;
+    }
+
+    static const unsigned MicrosecInSec = 1000000;
+    auto bits = static_cast<std::uint64_t>(charTimes) * BitsPerChar;
+    idleTimeoutUs_ = static_cast<unsigned>(
+        ((bits * MicrosecInSec) + (baud_ - 1)) / baud_);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
 template <typename TFunc>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setCanReadHandler(
     TFunc&& func)
 {
@@ -276,9 +606,10 @@ setCanReadHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
 template <typename TFunc>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setCanWriteHandler(
     TFunc&& func)
 {
@@ -287,9 +618,10 @@ setCanWriteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
 template <typename TFunc>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setReadCompleteHandler(
     TFunc&& func)
 {
@@ -298,9 +630,10 @@ setReadCompleteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
 template <typename TFunc>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setWriteCompleteHandler(
     TFunc&& func)
 {
@@ -310,23 +643,26 @@ setWriteCompleteHandler(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 startRead(std::size_t length, EventLoopContext context)
 {
     static_cast<void>(context);
     GASSERT(!isReadInterruptEnabled());
     GASSERT(remainingReadCount_ == 0);
     GASSERT(0 < length);
+    readLength_ = length;
     remainingReadCount_ = length;
     setReadInterruptEnabled(true);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
 template <typename TContext>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 cancelRead(TContext context)
 {
     static_cast<void>(context);
@@ -335,87 +671,167 @@ cancelRead(TContext context)
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 startWrite(std::size_t length, EventLoopContext context)
 {
     static_cast<void>(context);
-    GASSERT(!isWriteInterruptEnabled());
     GASSERT(remainingWriteCount_ == 0);
     GASSERT(0 < length);
+
+    // The interrupt handler may be servicing gather write
+    auto flags = interrupt::save();
+    interrupt::disable();
     remainingWriteCount_ = length;
-    setWriteInterruptEnabled(true);
+    if (writeOwner_ == WriteOwner_None) {
+        writeOwner_ = WriteOwner_Driver;
+        setWriteInterruptEnabled(true);
+    }
+    interrupt::restore(flags);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 cancelWrite(EventLoopContext context)
 {
     static_cast<void>(context);
-    setWriteInterruptEnabled(false);
+    auto flags = interrupt::save();
+    interrupt::disable();
     bool result = (0 < remainingWriteCount_);
     remainingWriteCount_ = 0;
+    if (writeOwner_ == WriteOwner_Driver) {
+        releaseWriteOwner();
+    }
+    interrupt::restore(flags);
+    return result;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+template <typename TFunc>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+setGatherWriteCompleteHandler(
+    TFunc&& func)
+{
+    gatherWriteCompleteHandler_ = std::forward<TFunc>(func);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+startGatherWrite(
+    const WriteSegment* segments,
+    std::size_t count,
+    EventLoopContext context)
+{
+    static_cast<void>(context);
+    GASSERT(0 < count);
+    GASSERT(count <= gatherSegments_.size());
+
+    // The interrupt handler may be servicing the driver write
+    auto flags = interrupt::save();
+    interrupt::disable();
+    GASSERT(gatherSegmentsCount_ == 0);
+    std::copy(segments, segments + count, gatherSegments_.begin());
+    gatherSegmentsCount_ = count;
+    gatherSegmentIdx_ = 0;
+    gatherSegmentPos_ = 0;
+    if (writeOwner_ == WriteOwner_None) {
+        writeOwner_ = WriteOwner_Gather;
+        setWriteInterruptEnabled(true);
+    }
+    interrupt::restore(flags);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
+cancelGatherWrite(EventLoopContext context)
+{
+    static_cast<void>(context);
+    auto flags = interrupt::save();
+    interrupt::disable();
+    bool result = (0 < gatherSegmentsCount_);
+    gatherSegmentsCount_ = 0;
+    if (writeOwner_ == WriteOwner_Gather) {
+        releaseWriteOwner();
+    }
+    interrupt::restore(flags);
     return result;
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 canRead(InterruptContext context)
 {
     static_cast<void>(context);
-    return (((*pAUX_MU_LSR_REG & genMask(DataReadyPos)) != 0) &&
-            ((0 < remainingReadCount_)));
+    return ((0 < rxFifoAvailable_) && (0 < remainingReadCount_));
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 canWrite(InterruptContext context)
 {
     static_cast<void>(context);
-    return (((*pAUX_MU_LSR_REG & genMask(TransmitterEmptyPos)) != 0) &&
-            (0 < remainingWriteCount_));
+    return ((0 < txFifoSpace_) && (0 < remainingWriteCount_));
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-typename Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::CharType
-Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+typename Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::CharType
+Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 read(InterruptContext context)
 {
     static_cast<void>(context);
     GASSERT(canRead(context));
     --remainingReadCount_;
+    --rxFifoAvailable_;
     return static_cast<CharType>(
         *pAUX_MU_IO_REG & genMask(IoDataPos, IoDataLen));
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 write(CharType value, InterruptContext context)
 {
     static_cast<void>(context);
     GASSERT(canWrite(context));
     --remainingWriteCount_;
+    --txFifoSpace_;
     *pAUX_MU_IO_REG =
         static_cast<EntryType>(value) & genMask(IoDataPos, IoDataLen);
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 cancelReadInternal()
 {
     setReadInterruptEnabled(false);
+    stopIdleTimer();
     bool result = (0 < remainingReadCount_);
     remainingReadCount_ = 0;
     return result;
@@ -423,8 +839,9 @@ cancelReadInternal()
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setReadInterruptEnabled(
     bool enabled)
 {
@@ -433,8 +850,9 @@ setReadInterruptEnabled(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 setWriteInterruptEnabled(
     bool enabled)
 {
@@ -444,45 +862,254 @@ setWriteInterruptEnabled(
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
 interruptHandler()
 {
+    // Service the whole FIFO contents in a single interrupt. The handlers
+    // are expected to read/write while canRead()/canWrite() report true,
+    // they are invoked again only if they stopped before that.
+    sampleFifoLevels();
+
     if (((*pAUX_MU_IIR_REG & genMask(RxInterruptPos)) != 0) &&
          (isReadInterruptEnabled())) {
 
-        if (canRead(InterruptContext())) {
-            GASSERT(canReadHandler_);
-            canReadHandler_();
-        }
+        serviceRead();
 
         if (remainingReadCount_ == 0) {
-            setReadInterruptEnabled(false);
-            GASSERT(readCompleteHandler_);
-            readCompleteHandler_(embxx::error::ErrorCode::Success);
+            completeRead();
+        }
+        else if ((0 < idleTimeoutUs_) && (remainingReadCount_ < readLength_)) {
+            restartIdleTimer();
         }
     }
 
     if (((*pAUX_MU_IIR_REG & genMask(TxInterruptPos)) != 0) &&
         (isWriteInterruptEnabled())) {
 
-        if (canWrite(InterruptContext())) {
-            GASSERT(canWriteHandler_);
-            canWriteHandler_();
+        if (writeOwner_ == WriteOwner_Gather) {
+            serviceGatherWrite();
+        }
+        else {
+            serviceWrite();
+        }
+    }
+
+    rxFifoAvailable_ = 0;
+    txFifoSpace_ = 0;
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+idleTimerInterruptHandler()
+{
+    // Mustn't be interrupted by the UART interrupt (possibly routed to FIQ)
+    auto flags = interrupt::save();
+    interrupt::disable();
+    stopIdleTimer();
+    if (isReadInterruptEnabled() && (remainingReadCount_ < readLength_)) {
+        sampleFifoLevels();
+        serviceRead();
+        rxFifoAvailable_ = 0;
+        txFifoSpace_ = 0;
+        remainingReadCount_ = 0;
+        completeRead();
+    }
+    interrupt::restore(flags);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+sampleFifoLevels()
+{
+    auto stat = *pAUX_MU_STAT_REG;
+    rxFifoAvailable_ =
+        (stat & genMask(RxFifoLevelPos, RxFifoLevelLen)) >> RxFifoLevelPos;
+    auto txFifoLevel =
+        (stat & genMask(TxFifoLevelPos, TxFifoLevelLen)) >> TxFifoLevelPos;
+    GASSERT(txFifoLevel <= FifoSize);
+    txFifoSpace_ = FifoSize - txFifoLevel;
+
+    // The overrun flag is cleared by reading the register
+    if ((*pAUX_MU_LSR_REG & genMask(ReceiverOverrunPos)) != 0) {
+        ++overrunCount_;
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+serviceRead()
+{
+    while (canRead(InterruptContext())) {
+        GASSERT(canReadHandler_);
+        auto prevAvailable = rxFifoAvailable_;
+        canReadHandler_();
+        if (prevAvailable == rxFifoAvailable_) {
+            break;
         }
+    }
+}
 
-        if (remainingWriteCount_ == 0) {
-            setWriteInterruptEnabled(false);
-            GASSERT(writeCompleteHandler_);
-            writeCompleteHandler_(embxx::error::ErrorCode::Success);
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+serviceWrite()
+{
+    while (canWrite(InterruptContext())) {
+        GASSERT(canWriteHandler_);
+        auto prevSpace = txFifoSpace_;
+        canWriteHandler_();
+        if (prevSpace == txFifoSpace_) {
+            break;
         }
     }
+
+    if (remainingWriteCount_ == 0) {
+        releaseWriteOwner();
+        GASSERT(writeCompleteHandler_);
+        writeCompleteHandler_(embxx::error::ErrorCode::Success);
+    }
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+serviceGatherWrite()
+{
+    while ((0 < txFifoSpace_) && (gatherSegmentIdx_ < gatherSegmentsCount_)) {
+        auto& segment = gatherSegments_[gatherSegmentIdx_];
+        if (gatherSegmentPos_ < segment.length_) {
+            *pAUX_MU_IO_REG =
+                static_cast<EntryType>(segment.data_[gatherSegmentPos_]) &
+                genMask(IoDataPos, IoDataLen);
+            ++gatherSegmentPos_;
+            --txFifoSpace_;
+        }
+
+        if (segment.length_ <= gatherSegmentPos_) {
+            ++gatherSegmentIdx_;
+            gatherSegmentPos_ = 0;
+        }
+    }
+
+    if (gatherSegmentIdx_ < gatherSegmentsCount_) {
+        return;
+    }
+
+    gatherSegmentsCount_ = 0;
+    releaseWriteOwner();
+    GASSERT(gatherWriteCompleteHandler_);
+    gatherWriteCompleteHandler_(embxx::error::ErrorCode::Success);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+releaseWriteOwner()
+{
+    // Hand the transmitter over to the pending write of the other user,
+    // the write interrupt stays enabled.
+    if ((writeOwner_ != WriteOwner_Gather) && (0 < gatherSegmentsCount_)) {
+        writeOwner_ = WriteOwner_Gather;
+        return;
+    }
+
+    if ((writeOwner_ != WriteOwner_Driver) && (0 < remainingWriteCount_)) {
+        writeOwner_ = WriteOwner_Driver;
+        return;
+    }
+
+    writeOwner_ = WriteOwner_None;
+    setWriteInterruptEnabled(false);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+completeRead()
+{
+    setReadInterruptEnabled(false);
+    stopIdleTimer();
+    GASSERT(readCompleteHandler_);
+    readCompleteHandler_(embxx::error::ErrorCode::Success);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+restartIdleTimer()
+{
+    *pSYS_TIMER_C3 = *pSYS_TIMER_CLO + idleTimeoutUs_;
+    *pSYS_TIMER_CS = genMask(Match3Pos); // Clear previous match
+    interruptMgr_.enableInterrupt(IrqId::IrqId_SystemTimer3);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+stopIdleTimer()
+{
+    interruptMgr_.disableInterrupt(IrqId::IrqId_SystemTimer3);
+    *pSYS_TIMER_CS = genMask(Match3Pos);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+registerInterruptHandler(std::nullptr_t* auxInterruptMgr)
+{
+    // The AUX interrupt is used exclusively by mini UART
+    static_cast<void>(auxInterruptMgr);
+    interruptMgr_.registerHandler(
+        IrqId::IrqId_AuxInt,
+        std::bind(&Uart1::interruptHandler, this));
+    interruptMgr_.enableInterrupt(IrqId::IrqId_AuxInt);
+}
+
+template <typename TInterruptMgr,
+          typename TCanDoHandler,
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+template <typename TAux>
+void Uart1<TInterruptMgr, TCanDoHandler,  TOpCompleteHandler, TAuxInterruptMgr>::
+registerInterruptHandler(TAux* auxInterruptMgr)
+{
+    // The demultiplexer keeps the AUX interrupt enabled
+    GASSERT(auxInterruptMgr != nullptr);
+    auxInterruptMgr->registerHandler(
+        TAux::IrqId_MiniUart,
+        std::bind(&Uart1::interruptHandler, this));
 }
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 isReadInterruptEnabled()
 {
     return ((*pAUX_MU_IER_REG & genMask(EnableRxInterruptPos)) != 0);
@@ -490,8 +1117,9 @@ isReadInterruptEnabled()
 
 template <typename TInterruptMgr,
           typename TCanDoHandler,
-          typename TOpCompleteHandler>
-bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler>::
+          typename TOpCompleteHandler,
+          typename TAuxInterruptMgr>
+bool Uart1<TInterruptMgr, TCanDoHandler, TOpCompleteHandler, TAuxInterruptMgr>::
 isWriteInterruptEnabled()
 {
     return ((*pAUX_MU_IER_REG & genMask(EnableTxInterruptPos)) != 0);
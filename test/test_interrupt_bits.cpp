@@ -0,0 +1,165 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+
+#include "device/InterruptBits.h"
+
+namespace
+{
+
+typedef device::interrupt::PendingType PendingType;
+typedef std::array<std::size_t, 32> BitToId;
+typedef std::vector<std::size_t> Invoked;
+
+unsigned failures = 0;
+
+#define CHECK(expr_) \
+    do { \
+        if (!(expr_)) { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr_); \
+            ++failures; \
+        } \
+    } while (false)
+
+BitToId makeBitToId()
+{
+    // Identifier is the bit index + 100 to distinguish it from the index
+    BitToId bitToId;
+    for (std::size_t idx = 0; idx < bitToId.size(); ++idx) {
+        bitToId[idx] = idx + 100;
+    }
+    return bitToId;
+}
+
+Invoked dispatch(PendingType pending, PendingType active)
+{
+    auto bitToId = makeBitToId();
+    Invoked invoked;
+    device::interrupt::dispatchPending(
+        pending,
+        active,
+        bitToId,
+        [&invoked](std::size_t id)
+        {
+            invoked.push_back(id);
+        });
+    return invoked;
+}
+
+void testMsbIdx()
+{
+    CHECK(device::interrupt::msbIdx(1U) == 0);
+    CHECK(device::interrupt::msbIdx(0x80000000U) == 31);
+    CHECK(device::interrupt::msbIdx(0x80000001U) == 31);
+    CHECK(device::interrupt::msbIdx(0x00018000U) == 16);
+    for (std::size_t idx = 0; idx < 32; ++idx) {
+        CHECK(device::interrupt::msbIdx(static_cast<PendingType>(1) << idx) == idx);
+    }
+}
+
+void testNothingPending()
+{
+    CHECK(dispatch(0, 0xffffffff).empty());
+}
+
+void testInactiveIgnored()
+{
+    // Pending bits 0, 15 and 19, only 15 is enabled
+    auto invoked = dispatch(0x00088001, 0x00008000);
+    CHECK(invoked.size() == 1);
+    CHECK((!invoked.empty()) && (invoked[0] == 115));
+}
+
+void testAllPendingDispatchedMsbFirst()
+{
+    auto invoked = dispatch(0x20300008, 0xffffffff);
+    CHECK((invoked == Invoked{129, 121, 120, 103}));
+}
+
+void testEveryBit()
+{
+    auto invoked = dispatch(0xffffffff, 0xffffffff);
+    CHECK(invoked.size() == 32);
+    for (std::size_t idx = 0; idx < invoked.size(); ++idx) {
+        CHECK(invoked[idx] == (131 - idx));
+    }
+}
+
+void testHandlerDeactivatesPendingSource()
+{
+    // Handler of bit 20 disables source of bit 3 which is pending as well
+    auto bitToId = makeBitToId();
+    PendingType active = 0x00100018;
+    Invoked invoked;
+    device::interrupt::dispatchPending(
+        0x00100018,
+        active,
+        bitToId,
+        [&invoked, &active](std::size_t id)
+        {
+            invoked.push_back(id);
+            if (id == 120) {
+                active &= ~static_cast<PendingType>(1U << 3);
+            }
+        });
+    CHECK((invoked == Invoked{120, 104}));
+}
+
+void testBitToIdMapping()
+{
+    // Sparse mapping as used by the interrupt managers
+    std::array<std::uint8_t, 32> bitToId;
+    bitToId.fill(0xff);
+    bitToId[29] = 1;
+    bitToId[20] = 9;
+    bitToId[3] = 11;
+
+    Invoked invoked;
+    device::interrupt::dispatchPending(
+        0x20100008,
+        0xffffffff,
+        bitToId,
+        [&invoked](std::size_t id)
+        {
+            invoked.push_back(id);
+        });
+    CHECK((invoked == Invoked{1, 9, 11}));
+}
+
+}  // namespace
+
+int main()
+{
+    testMsbIdx();
+    testNothingPending();
+    testInactiveIgnored();
+    testAllPendingDispatchedMsbFirst();
+    testEveryBit();
+    testHandlerDeactivatesPendingSource();
+    testBitToIdMapping();
+
+    if (failures != 0) {
+        std::printf("%u check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
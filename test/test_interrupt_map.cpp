@@ -0,0 +1,118 @@
+//
+// Copyright 2014 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+#include "device/InterruptMap.h"
+
+namespace
+{
+
+typedef device::InterruptIds InterruptIds;
+typedef device::interrupt::RegEntryType RegEntryType;
+
+unsigned failures = 0;
+
+#define CHECK(expr_) \
+    do { \
+        if (!(expr_)) { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #expr_); \
+            ++failures; \
+        } \
+    } while (false)
+
+bool isSingleBit(RegEntryType mask)
+{
+    return (mask != 0) && ((mask & (mask - 1)) == 0);
+}
+
+void testLocationsValid()
+{
+    for (auto idx = 0U; idx < InterruptIds::IrqId_NumOfIds; ++idx) {
+        auto location =
+            device::interrupt::getLocation(static_cast<InterruptIds::IrqId>(idx));
+        CHECK(location.pendingReg_ < device::interrupt::RegIdx_NumOfRegs);
+        CHECK(location.enDisReg_ < device::interrupt::RegIdx_NumOfRegs);
+        CHECK(isSingleBit(location.pendingMask_));
+        CHECK(isSingleBit(location.enDisMask_));
+    }
+}
+
+void testPendingBitsUnique()
+{
+    for (auto first = 0U; first < InterruptIds::IrqId_NumOfIds; ++first) {
+        auto firstLocation =
+            device::interrupt::getLocation(static_cast<InterruptIds::IrqId>(first));
+        for (auto second = first + 1; second < InterruptIds::IrqId_NumOfIds; ++second) {
+            auto secondLocation =
+                device::interrupt::getLocation(static_cast<InterruptIds::IrqId>(second));
+            CHECK((firstLocation.pendingReg_ != secondLocation.pendingReg_) ||
+                  (firstLocation.pendingMask_ != secondLocation.pendingMask_));
+            CHECK((firstLocation.enDisReg_ != secondLocation.enDisReg_) ||
+                  (firstLocation.enDisMask_ != secondLocation.enDisMask_));
+        }
+    }
+}
+
+void testBasicPendingSummaryBitsNotUsed()
+{
+    // Bits 8 and 9 of the basic pending register are not sources
+    for (auto idx = 0U; idx < InterruptIds::IrqId_NumOfIds; ++idx) {
+        auto location =
+            device::interrupt::getLocation(static_cast<InterruptIds::IrqId>(idx));
+        if (location.pendingReg_ == device::interrupt::RegIdx_Basic) {
+            CHECK((location.pendingMask_ & device::interrupt::BasicPending1Mask) == 0);
+            CHECK((location.pendingMask_ & device::interrupt::BasicPending2Mask) == 0);
+        }
+    }
+}
+
+void testKnownLocations()
+{
+    static_assert(
+        device::interrupt::getLocation(InterruptIds::IrqId_Timer).pendingReg_ ==
+            device::interrupt::RegIdx_Basic,
+        "Usable in constant expressions");
+
+    auto i2c = device::interrupt::getLocation(InterruptIds::IrqId_I2C);
+    CHECK(i2c.pendingReg_ == device::interrupt::RegIdx_Basic);
+    CHECK(i2c.pendingMask_ == (1U << 15));
+    CHECK(i2c.enDisReg_ == device::interrupt::RegIdx_2);
+    CHECK(i2c.enDisMask_ == (1U << 21));
+
+    auto aux = device::interrupt::getLocation(InterruptIds::IrqId_AuxInt);
+    CHECK(aux.pendingReg_ == device::interrupt::RegIdx_1);
+    CHECK(aux.pendingMask_ == (1U << 29));
+}
+
+}  // namespace
+
+int main()
+{
+    testLocationsValid();
+    testPendingBitsUnique();
+    testBasicPendingSummaryBitsNotUsed();
+    testKnownLocations();
+
+    if (failures != 0) {
+        std::printf("%u check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}